@@ -1,22 +1,11 @@
 #include <iostream>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include "choochoo/lexer.hpp"
 #include "choochoo/parser.hpp"
 #include "choochoo/value.hpp"
 
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            std::string_view key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
-
 int main() {
     std::string json_input = R"({
     "name": "Perry",
@@ -33,7 +22,7 @@ int main() {
     auto result = parser.parse();
 
     if (!result) {
-        std::cerr << "Parser error: " << result.error() << '\n';
+        std::cerr << "Parser error: " << result.error().message() << '\n';
         return 1;
     }
 
@@ -52,7 +41,7 @@ int main() {
             std::cout << "  Key: " << key << ", Type: " << static_cast<int>(value.type()) << "\n";
             if (*key == "name") {
                 if (value.type() == choochoo::json::Type::STRING) {
-                    std::cout << "  'name' value: " << value.as_string()->get() << "\n";
+                    std::cout << "  'name' value: " << value.as_string().value() << "\n";
                 }
                 else {
                     std::cout << "  'name' is not a string, type: " << static_cast<int>(value.type()) << "\n";
@@ -62,13 +51,11 @@ int main() {
 
                 // If "scores" is an array, iterate using new iterator support
                 if (root.type() == choochoo::json::Type::OBJECT) {
-                    auto obj_opt = root.as_object();
-                    const std::string* scores_kptr = find_key(obj_opt->get(), "scores");
-                    if (obj_opt && scores_kptr) {
-                        const auto& scores_val = obj_opt->get().at(scores_kptr);
-                        if (scores_val.type() == choochoo::json::Type::ARRAY) {
+                    const auto* scores_val = root.find("scores");
+                    if (scores_val != nullptr) {
+                        if (scores_val->type() == choochoo::json::Type::ARRAY) {
                             std::cout << "Scores (using iterator): ";
-                            for (const auto& score : scores_val) {
+                            for (const auto& score : *scores_val) {
                                 auto num = score.as_number();
                                 if (num)
                                     std::cout << *num << " ";
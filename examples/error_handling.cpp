@@ -10,7 +10,7 @@ int main() {
     auto result = parser.parse();
     if (!result) {
         std::cerr << "Failed to parse JSON:\n";
-        std::cerr << "  Error: " << result.error() << '\n';
+        std::cerr << "  Error: " << result.error().message() << '\n';
         return 1;
     }
 
@@ -1,16 +1,5 @@
 #include <choochoo/json.hpp>
 #include <iostream>
-#include <unordered_map>
-
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            const std::string& key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
 
 int main() {
     std::string json = R"({
@@ -23,28 +12,25 @@ int main() {
 
     auto result = parser.parse();
     if (!result) {
-        std::cerr << "Parse error: " << result.error() << '\n';
+        std::cerr << "Parse error: " << result.error().message() << '\n';
         return 1;
     }
 
     auto root = result.value();
-    const auto& obj = root.as_object()->get();
-    const std::string* fruits_kptr = find_key(obj, "fruits");
-    auto fruits_opt = fruits_kptr ? obj.at(fruits_kptr).as_array() : std::nullopt;
+    auto fruits_opt = root["fruits"].as_array();
     if (fruits_opt) {
         const auto& fruits = fruits_opt->get();
         std::cout << "Fruits: ";
         for (const auto& fruit : fruits) {
             auto str_opt = fruit.as_string();
             if (str_opt) {
-                std::cout << str_opt->get() << " ";
+                std::cout << *str_opt << " ";
             }
         }
         std::cout << '\n';
     }
 
-    const std::string* prices_kptr = find_key(obj, "prices");
-    auto prices_opt = prices_kptr ? obj.at(prices_kptr).as_object() : std::nullopt;
+    auto prices_opt = root["prices"].as_object();
     if (prices_opt) {
         const auto& prices = prices_opt->get();
         std::cout << "Prices:\n";
@@ -2,17 +2,6 @@
 #include <iostream>
 #include <string>
 #include <string_view>
-#include <unordered_map>
-
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            std::string_view key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
 
 int main() {
     std::string json_input = R"({
@@ -29,17 +18,16 @@ int main() {
 
     auto result = parser.parse();
     if (!result) {
-        std::cerr << "Parse error: " << result.error() << '\n';
+        std::cerr << "Parse error: " << result.error().message() << '\n';
         return 1;
     }
     auto root = result.value();
 
     // --- Array iteration example ---
     std::cout << "Iterating over 'numbers' array using range-based for:\n";
-    auto obj_opt = root.as_object();
-    const std::string* numbers_kptr = obj_opt ? find_key(obj_opt->get(), "numbers") : nullptr;
-    if (obj_opt && numbers_kptr) {
-        const auto& numbers_val = obj_opt->get().at(numbers_kptr);
+    const auto* numbers = root.find("numbers");
+    if (numbers != nullptr) {
+        const auto& numbers_val = *numbers;
         if (numbers_val.type() == choochoo::json::Type::ARRAY) {
             for (const auto& num : numbers_val) {
                 auto n = num.as_number();
@@ -53,18 +41,16 @@ int main() {
 
     // --- Array iteration using manual iterators ---
     std::cout << "Iterating over 'languages' array using manual iterators:\n";
-    const std::string* person_kptr = obj_opt ? find_key(obj_opt->get(), "person") : nullptr;
-    if (obj_opt && person_kptr) {
-        const auto& person_val = obj_opt->get().at(person_kptr);
-        auto person_obj = person_val.as_object();
-        const std::string* langs_kptr = person_obj ? find_key(person_obj->get(), "languages") : nullptr;
-        if (person_obj && langs_kptr) {
-            const auto& langs_val = person_obj->get().at(langs_kptr);
+    const auto* person = root.find("person");
+    if (person != nullptr) {
+        const auto* langs = person->find("languages");
+        if (langs != nullptr) {
+            const auto& langs_val = *langs;
             if (langs_val.type() == choochoo::json::Type::ARRAY) {
                 for (auto it = langs_val.begin(); it != langs_val.end(); ++it) {
                     auto str = it->as_string();
                     if (str) {
-                        std::cout << str->get() << " ";
+                        std::cout << *str << " ";
                     }
                 }
                 std::cout << '\n';
@@ -74,13 +60,13 @@ int main() {
 
     // --- Object iteration example ---
     std::cout << "Iterating over 'person' object using obj_begin/obj_end:\n";
-    if (obj_opt && person_kptr) {
-        const auto& person_val = obj_opt->get().at(person_kptr);
+    if (person != nullptr) {
+        const auto& person_val = *person;
         if (person_val.type() == choochoo::json::Type::OBJECT) {
             for (auto it = person_val.obj_begin(); it != person_val.obj_end(); ++it) {
                 std::cout << "  " << *(it->first) << ": ";
                 if (it->second.type() == choochoo::json::Type::STRING) {
-                    std::cout << it->second.as_string()->get();
+                    std::cout << it->second.as_string().value();
                 }
                 else if (it->second.type() == choochoo::json::Type::NUMBER) {
                     std::cout << it->second.as_number().value();
@@ -98,8 +84,8 @@ int main() {
 
     // --- STL algorithm compatibility example ---
     std::cout << "Using std::find_if to search for number 3 in 'numbers':\n";
-    if (obj_opt && numbers_kptr) {
-        const auto& numbers_val = obj_opt->get().at(numbers_kptr);
+    if (numbers != nullptr) {
+        const auto& numbers_val = *numbers;
         if (numbers_val.type() == choochoo::json::Type::ARRAY) {
             auto it = std::find_if(numbers_val.begin(), numbers_val.end(), [](const choochoo::json::Value& v) {
                 auto n = v.as_number();
@@ -1,16 +1,5 @@
 #include <choochoo/json.hpp>
 #include <iostream>
-#include <unordered_map>
-
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            const std::string& key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
 
 int main() {
     std::string json = R"({
@@ -26,29 +15,23 @@ int main() {
 
     auto result = parser.parse();
     if (!result) {
-        std::cerr << "Parse error: " << result.error() << '\n';
+        std::cerr << "Parse error: " << result.error().message() << '\n';
         return 1;
     }
 
     auto root = result.value();
-    auto user_obj_opt = root.as_object();
-    if (!user_obj_opt) {
+    if (root.type() != choochoo::json::Type::OBJECT) {
         std::cerr << "Root is not an object." << '\n';
         return 1;
     }
-    const auto& obj = user_obj_opt->get();
-    const std::string* user_kptr = find_key(obj, "user");
-    auto user_obj = user_kptr ? obj.at(user_kptr).as_object() : std::nullopt;
-    if (user_obj) {
-        const auto& user_map = user_obj->get();
-        const std::string* name_kptr = find_key(user_map, "name");
-        const std::string* age_kptr = find_key(user_map, "age");
-        const std::string* scores_kptr = find_key(user_map, "scores");
-        if (name_kptr)
-            std::cout << "Name: " << user_map.at(name_kptr).as_string()->get() << '\n';
-        if (age_kptr)
-            std::cout << "Age: " << user_map.at(age_kptr).as_number().value() << '\n';
-        auto scores = scores_kptr ? user_map.at(scores_kptr).as_array() : std::nullopt;
+    // operator[] yields null for missing members, so lookups chain without checks in between
+    const auto& user = root["user"];
+    if (user.type() == choochoo::json::Type::OBJECT) {
+        if (const auto* name = user.find("name"))
+            std::cout << "Name: " << name->as_string().value() << '\n';
+        if (const auto* age = user.find("age"))
+            std::cout << "Age: " << age->as_number().value() << '\n';
+        auto scores = user["scores"].as_array();
         if (scores) {
             std::cout << "Scores: ";
             for (const auto& score : scores->get()) {
@@ -61,5 +44,10 @@ int main() {
         std::cerr << "'user' is not an object." << '\n';
         return 1;
     }
+
+    // A compiled path reaches the same data in one step and can be reused for every document
+    static const auto first_score = choochoo::json::Path::dotted("user.scores[0]");
+    if (const auto* score = first_score->find(root))
+        std::cout << "First score: " << score->as_number().value() << '\n';
     return 0;
 }
@@ -2,17 +2,6 @@
 #include <iostream>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            const std::string& key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
 
 int main() {
     // Simulate streaming input using std::istringstream
@@ -33,7 +22,7 @@ int main() {
 
     auto result = parser.parse();
     if (!result) {
-        std::cerr << "Streaming parse error: " << result.error() << '\n';
+        std::cerr << "Streaming parse error: " << result.error().message() << '\n';
         return 1;
     }
 
@@ -42,20 +31,15 @@ int main() {
     std::cout << "Pretty JSON:\n" << root.pretty() << '\n';
 
     // Access streamed values
-    auto obj_opt = root.as_object();
-    if (obj_opt) {
-        const auto& obj = obj_opt->get();
-        const std::string* streamed_kptr = find_key(obj, "streamed");
-        if (streamed_kptr) {
-            auto streamed_val = obj.at(streamed_kptr).as_boolean();
+    if (root.type() == choochoo::json::Type::OBJECT) {
+        if (const auto* streamed = root.find("streamed")) {
+            auto streamed_val = streamed->as_boolean();
             std::cout << "streamed: " << (streamed_val.value() ? "true" : "false") << '\n';
         }
-        const std::string* numbers_kptr = find_key(obj, "numbers");
-        if (numbers_kptr) {
-            const auto& numbers_val = obj.at(numbers_kptr);
-            if (numbers_val.type() == choochoo::json::Type::ARRAY) {
+        if (const auto* numbers = root.find("numbers")) {
+            if (numbers->type() == choochoo::json::Type::ARRAY) {
                 std::cout << "numbers: ";
-                for (const auto& num : numbers_val) {
+                for (const auto& num : *numbers) {
                     auto n = num.as_number();
                     if (n)
                         std::cout << *n << " ";
@@ -63,21 +47,11 @@ int main() {
                 std::cout << '\n';
             }
         }
-        const std::string* info_kptr = find_key(obj, "info");
-        if (info_kptr) {
-            const auto& info_val = obj.at(info_kptr);
-            auto info_obj = info_val.as_object();
-            if (info_obj) {
-                const auto& info_map = info_obj->get();
-                const std::string* source_kptr = find_key(info_map, "source");
-                const std::string* valid_kptr = find_key(info_map, "valid");
-                if (source_kptr)
-                    std::cout << "info.source: " << info_map.at(source_kptr).as_string()->get() << '\n';
-                if (valid_kptr)
-                    std::cout << "info.valid: " << (info_map.at(valid_kptr).as_boolean().value() ? "true" : "false")
-                              << '\n';
-            }
-        }
+        const auto& info = root["info"];
+        if (const auto* source = info.find("source"))
+            std::cout << "info.source: " << source->as_string().value() << '\n';
+        if (const auto* valid = info.find("valid"))
+            std::cout << "info.valid: " << (valid->as_boolean().value() ? "true" : "false") << '\n';
     }
 
     return 0;
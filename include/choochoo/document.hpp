@@ -0,0 +1,59 @@
+#pragma once
+#include <expected>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include "choochoo/error.hpp"
+#include "choochoo/key.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    /// Read-only contents of a whole file. Memory-mapped on POSIX systems; read into memory elsewhere.
+    struct MappedFile {
+    protected:
+        const char* data_{nullptr};
+        size_t size_{0};
+        bool mapped_{false};
+        std::string buffer_; // Fallback storage when the file is not mapped
+
+        MappedFile() = default;
+
+    public:
+        /// Fails with FILE_OPEN_FAILED, FILE_STAT_FAILED or FILE_MAP_FAILED and the errno of the failed call.
+        static std::expected<std::shared_ptr<const MappedFile>, Error> open(const std::string& path);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        [[nodiscard]] const char* data() const;
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] std::string_view view() const;
+    };
+
+    /// A parsed root value together with everything it depends on: the table its keys are interned in, the arena its
+    /// containers were allocated from (if any) and, for documents parsed from a file, the file mapping.
+    struct Document {
+    protected:
+        std::shared_ptr<const MappedFile> file_;
+        std::shared_ptr<KeyTable> keys_;
+        std::unique_ptr<std::pmr::memory_resource> arena_;
+        Value root_; // Declared last so it is destroyed before the arena it lives in
+
+    public:
+        Document(Value root, std::shared_ptr<KeyTable> keys, std::shared_ptr<const MappedFile> file = nullptr,
+                 std::unique_ptr<std::pmr::memory_resource> arena = nullptr);
+
+        [[nodiscard]] const Value& root() const;
+        [[nodiscard]] Value& root();
+
+        /// The bytes the document was parsed from, or an empty view if they were not kept.
+        [[nodiscard]] std::string_view source() const;
+    };
+
+    /// Map `path` read-only and parse it in place, without copying the file into a string first. The tree is
+    /// allocated from a monotonic arena owned by the Document and released in one go with it. Strings without escapes
+    /// are views into the mapping rather than copies. Fails with the error of MappedFile::open() or of the parse.
+    std::expected<Document, Error> parse_file(const std::string& path);
+} // namespace choochoo::json
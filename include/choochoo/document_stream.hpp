@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <expected>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include "choochoo/document.hpp"
+#include "choochoo/error.hpp"
+#include "choochoo/key.hpp"
+#include "choochoo/lexer.hpp"
+#include "choochoo/parser.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    /// One document read by a DocumentStream.
+    struct StreamDocument {
+        std::expected<Value, Error> value;
+        size_t begin{}; // Input offset of its first byte
+        size_t end{};   // Input offset just past its last byte; for a failed document, just past the bytes skipped
+    };
+
+    /// Reads newline-delimited JSON (JSON Lines), or any other concatenation of whitespace-separated JSON values, one
+    /// document at a time from a string, a memory-mapped file or a stream. A single Lexer and Parser serve the whole
+    /// input, so nothing is set up per document; hand finished values back through recycle() to reuse their
+    /// containers as well.
+    ///
+    /// A malformed document is reported with its error and the stream moves on: to the line the error was found on
+    /// when that is a later line than the one the document started on, since the document was probably cut short,
+    /// and otherwise to the next line.
+    ///
+    /// With ParseOptions::zero_copy_strings, values may view the input, which must then outlive them; for a mapped
+    /// file, that means outliving the stream. Stream input is never viewed.
+    struct DocumentStream {
+    protected:
+        std::shared_ptr<const MappedFile> file_; // Only for file input
+        Lexer lexer_;
+        Parser parser_; // Reads lexer_
+
+    public:
+        /// Reads `input`, which must outlive the stream.
+        explicit DocumentStream(std::string_view input, ParseOptions options = {});
+        /// Reads a file opened with MappedFile::open().
+        explicit DocumentStream(std::shared_ptr<const MappedFile> file, ParseOptions options = {});
+        /// Reads `input` a block at a time. A document is returned once the token after it has been read, so on an
+        /// interactive stream next() waits for the start of the following document or the end of input.
+        explicit DocumentStream(std::istream& input, ParseOptions options = {},
+                                size_t block_size = Lexer::DEFAULT_STREAM_BLOCK_SIZE);
+        DocumentStream(const DocumentStream&) = delete;
+        DocumentStream& operator=(const DocumentStream&) = delete;
+
+        /// The next document, or nothing once only whitespace is left.
+        std::optional<StreamDocument> next();
+        /// Destroy a finished value, keeping its containers for the next documents.
+        void recycle(Value&& tree);
+
+        /// The table the keys of the next parsed objects will live in.
+        [[nodiscard]] const std::shared_ptr<KeyTable>& key_table() const;
+
+        /// Reads the remaining documents: `for (auto& document : stream)`.
+        struct iterator {
+        protected:
+            DocumentStream* stream_{nullptr};
+            std::optional<StreamDocument> current_; // Empty past the end
+
+            explicit iterator(DocumentStream* stream);
+
+            friend struct DocumentStream;
+
+        public:
+            iterator() = default;
+
+            StreamDocument& operator*();
+            StreamDocument* operator->();
+            iterator& operator++();
+            bool operator==(const iterator& other) const;
+        };
+
+        [[nodiscard]] iterator begin();
+        [[nodiscard]] iterator end();
+    };
+} // namespace choochoo::json
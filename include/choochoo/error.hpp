@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "choochoo/token.hpp"
+
+namespace choochoo::json {
+    /// Why reading JSON, a file or a path failed.
+    enum class ErrorCode : uint8_t {
+        UNEXPECTED_EOF,         // The input ended where a value was required
+        UNEXPECTED_TOKEN,       // A token that cannot start a value
+        UNEXPECTED_CHARACTER,   // A byte that starts no token at all
+        UNTERMINATED_STRING,    // A string without its closing quote
+        CONTROL_CHARACTER,      // A raw byte below 0x20, such as a newline, inside a string; JSON requires an escape
+        INVALID_LITERAL,        // A word other than true, false or null
+        INVALID_NUMBER,         // Malformed, or too large for a double
+        INVALID_ESCAPE,         // A backslash followed by anything but " \ / b f n r t u
+        INVALID_UNICODE_ESCAPE, // \u without four hex digits, or a lone surrogate
+        EXPECTED_KEY,           // An object member that does not start with a string key
+        EXPECTED_COLON,         // A key not followed by ':'
+        EXPECTED_OBJECT_END,    // An object member not followed by ',' or '}'
+        EXPECTED_ARRAY_END,     // An array element not followed by ',' or ']'
+        DEPTH_EXCEEDED,         // Nesting deeper than ParseOptions::max_depth
+        TRAILING_CONTENT,       // More input after the complete value
+        INPUT_TOO_LARGE,        // 4 GiB or more for a StructuralIndex
+
+        // ondemand cursors
+        EXPECTED_VALUE,         // Nothing that starts a value
+        EXPECTED_OBJECT,        // An object was asked for
+        EXPECTED_ARRAY,         // An array was asked for
+        EXPECTED_STRING,        // A string was asked for
+        EXPECTED_NUMBER,        // A number was asked for
+        EXPECTED_INT64,         // An integer that fits in an int64_t was asked for
+        EXPECTED_BOOLEAN,       // true or false was asked for
+        MALFORMED_VALUE,        // A value skipped over that runs off the end or is not JSON
+        NO_SUCH_FIELD,          // An object lookup found no member of that name
+        INDEX_OUT_OF_RANGE,     // An array lookup past the last element
+
+        // Path compilation; offset is the position in the path
+        POINTER_WITHOUT_SLASH,   // A non-empty JSON Pointer not starting with '/'
+        INVALID_POINTER_ESCAPE,  // '~' followed by anything but '0' or '1'
+        EMPTY_PATH_NAME,         // A dotted path with nothing between two separators
+        UNTERMINATED_PATH_INDEX, // '[' without its ']'
+        INVALID_PATH_INDEX,      // Brackets around anything but a decimal index
+        EXPECTED_PATH_SEPARATOR, // An index not followed by '.', '[' or the end
+
+        // Files; system_error holds the errno
+        FILE_OPEN_FAILED,
+        FILE_STAT_FAILED,
+        FILE_MAP_FAILED
+    };
+
+    /// Name of a token type for error messages, e.g. "LBRACE".
+    const char* token_type_name(token::Type type);
+
+    /// A failure to read JSON, a file or a path. It holds no text, so building and returning one never allocates.
+    /// message() formats a description only when someone asks for it.
+    struct Error {
+        ErrorCode code{};
+        token::Type token{token::Type::INVALID}; // Type of the token found where the error was detected
+        size_t offset{};                         // Byte offset into the input
+        size_t line{};                           // 1-based, like column; 0 when not known, e.g. from unescape()
+        size_t column{};
+        int system_error{}; // errno of a failed file operation, 0 otherwise
+
+        /// E.g. "Expected ',' or ']' in array, but found NUMBER at line 1, column 4.", or for a path
+        /// "Unterminated '[' in path at position 3.".
+        [[nodiscard]] std::string message() const;
+    };
+} // namespace choochoo::json
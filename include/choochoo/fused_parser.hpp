@@ -0,0 +1,361 @@
+#pragma once
+#include <concepts>
+#include <cstring>
+#include <expected>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "choochoo/error.hpp"
+#include "choochoo/key.hpp"
+#include "choochoo/number.hpp"
+#include "choochoo/parser.hpp"
+#include "choochoo/simd.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    /// Any contiguous input: std::string_view, std::string, or another type exposing data() and size().
+    template <typename Source>
+    concept ContiguousSource = requires(const Source& source) {
+        { source.data() } -> std::convertible_to<const char*>;
+        { source.size() } -> std::convertible_to<size_t>;
+    };
+
+    /// Single-pass parser that dispatches on the next input byte instead of pulling Token objects from a Lexer.
+    ///
+    /// Produces the same Value as Parser::parse() for the same input. Line and column are only worked out when an
+    /// error is reported. As with Parser, object keys are interned in ParseOptions::key_table, or else in a table of
+    /// the parser's own. ParseOptions::zero_copy_strings only applies to a std::string_view source: any other source
+    /// is a copy held by the parser, which the tree would outlive. Like Parser, it keeps open containers on an
+    /// explicit stack, so deep nesting costs heap rather than call stack.
+    template <ContiguousSource Source = std::string_view>
+    struct FusedParser {
+    protected:
+        Source source_;
+        const char* begin_{}; // Into source_
+        const char* pos_{};
+        const char* end_{};
+        std::shared_ptr<KeyTable> key_table_; // For string interning of object keys
+        std::pmr::memory_resource* resource_;
+        bool zero_copy_strings_;
+        size_t max_depth_;
+
+        /// An array or object still being filled, with the key of the member whose value is being parsed.
+        struct Frame {
+            bool is_object;
+            Array array;
+            Object object;
+            const Key* key{nullptr};
+        };
+        std::vector<Frame> stack_; // Open containers, innermost last; kept between parses to reuse its capacity
+
+        static bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+        static bool is_number_char(char c) {
+            return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+        }
+
+        void skip_whitespace() {
+            if (pos_ < end_ && !is_whitespace(*pos_)) {
+                return;
+            }
+            size_t newlines = 0;
+            const char* line_start = nullptr;
+            pos_ = simd::skip_whitespace(pos_, end_, newlines, line_start);
+        }
+
+        /// The token type that would start at `at`, for Error::token.
+        [[nodiscard]] token::Type token_at(const char* at) const {
+            if (at == end_) {
+                return token::Type::EOF_TOKEN;
+            }
+            switch (*at) {
+            case '{':
+                return token::Type::LBRACE;
+            case '}':
+                return token::Type::RBRACE;
+            case '[':
+                return token::Type::LBRACKET;
+            case ']':
+                return token::Type::RBRACKET;
+            case ',':
+                return token::Type::COMMA;
+            case ':':
+                return token::Type::COLON;
+            case '"':
+                return token::Type::STRING;
+            default:
+                return *at == '-' || (*at >= '0' && *at <= '9') ? token::Type::NUMBER : token::Type::INVALID;
+            }
+        }
+
+        [[nodiscard]] std::unexpected<Error> error(ErrorCode code, const char* at) const {
+            size_t line = 1;
+            const char* line_start = begin_;
+            for (const char* p = begin_; p < at; ++p) {
+                if (*p == '\n') {
+                    ++line;
+                    line_start = p + 1;
+                }
+            }
+            return std::unexpected(Error{code, token_at(at), static_cast<size_t>(at - begin_), line,
+                                         static_cast<size_t>(at - line_start + 1)});
+        }
+
+        /// Nothing that starts a value at pos_.
+        [[nodiscard]] std::unexpected<Error> no_value_here() const {
+            if (pos_ == end_) {
+                return error(ErrorCode::UNEXPECTED_EOF, pos_);
+            }
+            if ((*pos_ >= 'a' && *pos_ <= 'z') || (*pos_ >= 'A' && *pos_ <= 'Z')) {
+                return error(ErrorCode::INVALID_LITERAL, pos_);
+            }
+            return error(token_at(pos_) == token::Type::INVALID ? ErrorCode::UNEXPECTED_CHARACTER
+                                                                : ErrorCode::UNEXPECTED_TOKEN,
+                         pos_);
+        }
+
+        /// An error from unescape() on the raw string body `raw`, located within the input.
+        [[nodiscard]] std::unexpected<Error> error_in_string(const Error& unescape_error, std::string_view raw) const {
+            return error(unescape_error.code, raw.data() + unescape_error.offset);
+        }
+
+        /// Scan the string whose opening quote is under pos_ and return its raw body.
+        std::expected<std::string_view, Error> scan_string(bool& has_escapes) {
+            const char* const quote = pos_++;
+            has_escapes = false;
+            while (true) {
+                pos_ = simd::find_string_special(pos_, end_);
+                if (pos_ == end_ || *pos_ == '\0') {
+                    return error(ErrorCode::UNTERMINATED_STRING, quote);
+                }
+                if (*pos_ == '"') {
+                    break;
+                }
+                if (*pos_ == '\\') {
+                    has_escapes = true;
+                    if (++pos_ == end_ || *pos_ == '\0') {
+                        return error(ErrorCode::UNTERMINATED_STRING, quote);
+                    }
+                }
+                // As in the Lexer, a raw newline ends the string here rather than swallowing the lines after it
+                if (static_cast<unsigned char>(*pos_) < 0x20) {
+                    return error(ErrorCode::CONTROL_CHARACTER, quote);
+                }
+                ++pos_;
+            }
+            const std::string_view raw(quote + 1, pos_ - quote - 1);
+            ++pos_;
+            return raw;
+        }
+
+        bool match_literal(std::string_view word) {
+            const auto length = static_cast<std::ptrdiff_t>(word.size());
+            if (end_ - pos_ < length || std::memcmp(pos_, word.data(), word.size()) != 0) {
+                return false;
+            }
+            // Like the Lexer, a literal followed by more letters (`truex`) is one invalid word
+            if (end_ - pos_ > length) {
+                const char next = pos_[length];
+                if ((next >= 'a' && next <= 'z') || (next >= 'A' && next <= 'Z')) {
+                    return false;
+                }
+            }
+            pos_ += length;
+            return true;
+        }
+
+        /// A string, number or literal at pos_, or the error for whatever is there instead.
+        std::expected<Value, Error> parse_scalar() {
+            if (pos_ == end_) {
+                return error(ErrorCode::UNEXPECTED_EOF, pos_);
+            }
+            switch (*pos_) {
+            case '"': {
+                bool has_escapes = false;
+                auto raw = scan_string(has_escapes);
+                if (!raw)
+                    return std::unexpected(raw.error());
+                if (!has_escapes) {
+                    return zero_copy_strings_ ? Value::borrowed_string(raw.value())
+                                              : Value::string(raw.value(), resource_);
+                }
+                auto string_result = unescape(raw.value(), resource_);
+                if (!string_result)
+                    return error_in_string(string_result.error(), raw.value());
+                return Value::string(std::move(string_result.value()));
+            }
+            case 't':
+                if (match_literal("true"))
+                    return Value::boolean(true);
+                break;
+            case 'f':
+                if (match_literal("false"))
+                    return Value::boolean(false);
+                break;
+            case 'n':
+                if (match_literal("null"))
+                    return Value::null();
+                break;
+            case '-':
+            case '0':
+            case '1':
+            case '2':
+            case '3':
+            case '4':
+            case '5':
+            case '6':
+            case '7':
+            case '8':
+            case '9': {
+                const char* const start = pos_;
+                while (pos_ < end_ && is_number_char(*pos_)) {
+                    ++pos_;
+                }
+                auto num = number::parse_double(std::string_view(start, pos_ - start));
+                if (!num) {
+                    return error(ErrorCode::INVALID_NUMBER, start);
+                }
+                return Value::number(*num);
+            }
+            default:
+                break;
+            }
+            return no_value_here();
+        }
+
+        /// A member name and the colon after it.
+        std::expected<const Key*, Error> parse_key() {
+            skip_whitespace();
+            if (pos_ == end_ || *pos_ != '"') {
+                return error(ErrorCode::EXPECTED_KEY, pos_);
+            }
+            bool has_escapes = false;
+            auto raw = scan_string(has_escapes);
+            if (!raw)
+                return std::unexpected(raw.error());
+            const Key* key = nullptr;
+            if (!has_escapes) {
+                key = key_table_->intern(raw.value());
+            }
+            else {
+                auto key_result = unescape(raw.value());
+                if (!key_result)
+                    return error_in_string(key_result.error(), raw.value());
+                key = key_table_->intern(key_result.value());
+            }
+
+            skip_whitespace();
+            if (pos_ == end_ || *pos_ != ':') {
+                return error(ErrorCode::EXPECTED_COLON, pos_);
+            }
+            ++pos_;
+            return key;
+        }
+
+        std::expected<Value, Error> parse_value() {
+            // Open containers live on stack_ rather than the call stack, so nesting depth costs heap, not stack frames
+            const auto fail = [this](std::unexpected<Error> error) -> std::expected<Value, Error> {
+                stack_.clear();
+                return error;
+            };
+
+            Value value;
+            while (true) {
+                skip_whitespace();
+                if (pos_ < end_ && (*pos_ == '{' || *pos_ == '[')) {
+                    // Checked at the opening bracket, before anything of the container is read
+                    if (stack_.size() >= max_depth_)
+                        return fail(error(ErrorCode::DEPTH_EXCEEDED, pos_));
+                    const bool is_object = *pos_++ == '{';
+                    skip_whitespace();
+                    if (pos_ == end_ || *pos_ != (is_object ? '}' : ']')) {
+                        Frame& frame = stack_.emplace_back(Frame{is_object, Array(resource_), Object(resource_)});
+                        if (!is_object) {
+                            frame.array.reserve(8);
+                            continue; // Parse its first element
+                        }
+                        frame.object.reserve(8);
+                        auto key = parse_key();
+                        if (!key)
+                            return fail(std::unexpected(key.error()));
+                        frame.key = key.value();
+                        continue;
+                    }
+                    ++pos_;
+                    value = is_object ? Value::object(Object(resource_)) : Value::array(Array(resource_));
+                }
+                else {
+                    auto scalar = parse_scalar();
+                    if (!scalar)
+                        return fail(std::unexpected(scalar.error()));
+                    value = std::move(scalar.value());
+                }
+
+                // Add the value to the innermost container, closing every container it completes
+                while (true) {
+                    if (stack_.empty()) {
+                        return value;
+                    }
+                    Frame& frame = stack_.back();
+                    if (frame.is_object) {
+                        frame.object.emplace(frame.key, std::move(value));
+                    }
+                    else {
+                        frame.array.emplace_back(std::move(value));
+                    }
+
+                    skip_whitespace();
+                    if (pos_ < end_ && *pos_ == ',') {
+                        ++pos_;
+                        if (frame.is_object) {
+                            auto key = parse_key();
+                            if (!key)
+                                return fail(std::unexpected(key.error()));
+                            frame.key = key.value();
+                        }
+                        break;
+                    }
+                    if (pos_ == end_ || *pos_ != (frame.is_object ? '}' : ']')) {
+                        return fail(error(frame.is_object ? ErrorCode::EXPECTED_OBJECT_END
+                                                          : ErrorCode::EXPECTED_ARRAY_END,
+                                          pos_));
+                    }
+                    ++pos_;
+                    value = frame.is_object ? Value::object(std::move(frame.object))
+                                            : Value::array(std::move(frame.array));
+                    stack_.pop_back();
+                }
+            }
+        }
+
+    public:
+        explicit FusedParser(Source source, ParseOptions options = {}) :
+            source_(std::move(source)),
+            key_table_(options.key_table != nullptr ? std::move(options.key_table) : std::make_shared<KeyTable>()),
+            resource_(options.memory_resource != nullptr ? options.memory_resource : std::pmr::get_default_resource()),
+            zero_copy_strings_(options.zero_copy_strings && std::is_same_v<Source, std::string_view>),
+            max_depth_(options.max_depth) {
+            begin_ = source_.data();
+            pos_ = begin_;
+            end_ = begin_ + source_.size();
+        }
+        // begin_, pos_ and end_ point into source_, which a copy or move of an owning Source would leave behind
+        FusedParser(const FusedParser&) = delete;
+        FusedParser& operator=(const FusedParser&) = delete;
+
+        std::expected<Value, Error> parse() {
+            pos_ = begin_;
+            auto result = parse_value();
+            if (!result)
+                return result;
+            skip_whitespace();
+            if (pos_ != end_)
+                return error(ErrorCode::TRAILING_CONTENT, pos_);
+            return result;
+        }
+    };
+} // namespace choochoo::json
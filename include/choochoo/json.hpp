@@ -1,9 +1,23 @@
 #pragma once
 
+#include "document.hpp"
+#include "document_stream.hpp"
+#include "error.hpp"
+#include "fused_parser.hpp"
+#include "key.hpp"
 #include "lexer.hpp"
+#include "number.hpp"
+#include "ondemand.hpp"
+#include "parse_context.hpp"
 #include "parser.hpp"
+#include "path.hpp"
+#include "sax.hpp"
+#include "serialize.hpp"
+#include "simd.hpp"
+#include "structural_index.hpp"
 #include "token.hpp"
 #include "value.hpp"
+#include "writer.hpp"
 
 
 // Optionally, you can add convenience aliases or helper functions here
@@ -23,5 +37,17 @@
 // This header includes all core components of the ChooChoo JSON library:
 //   - Lexer: Tokenizes JSON input
 //   - Parser: Parses tokens into a JSON value tree
+//   - Document / parse_file: Parse memory-mapped files into a self-contained document
+//   - DocumentStream: Newline-delimited / concatenated JSON read one document at a time with its byte range
+//   - Error: Allocation-free ErrorCode plus location of a parse failure, formatted by message() on demand
+//   - FusedParser: Header-only parser that dispatches on input bytes without Token objects
+//   - Key / KeyTable: Interned object keys carrying their precomputed hash, kept alive by the objects using them
+//   - ondemand::Document: Cursors that parse only the fields and elements that are read
+//   - ParseContext: Reusable Lexer + Parser that keeps its stack, keys and containers across documents
+//   - Path: Compiled JSON Pointer / dotted path queries into a Value tree
+//   - sax::parse: Event handler parsing that stops whenever the handler says so, without building a tree
+//   - serialize / dump: Compact or indented JSON output with shortest round-trip numbers
+//   - StructuralIndex: SIMD stage-1 index the Parser can walk instead of lexing
 //   - Value: Represents JSON values (object, array, string, number, etc.)
+//   - Writer: Streaming begin_object()/key()/value() output without building a Value tree
 //
@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace choochoo::json {
+    struct KeyTable;
+
+    /// An interned object key: the key text together with its hash, computed once when the key is interned.
+    ///
+    /// Objects refer to keys by `const Key*`. Lookups by name hash the name once and compare it against the stored
+    /// hashes, so the keys themselves are never rehashed.
+    struct Key : std::string {
+    protected:
+        size_t hash_;
+        KeyTable* table_;
+
+    public:
+        explicit Key(std::string_view text, KeyTable* table = nullptr);
+
+        [[nodiscard]] size_t hash() const { return hash_; }
+        /// The table that interned this key; nullptr for a key constructed on its own.
+        [[nodiscard]] KeyTable* table() const { return table_; }
+
+        /// The hash a Key with this text stores.
+        static size_t hash_of(std::string_view text);
+    };
+
+    /// Thread-safe key interner, shared by the parsers and documents that use it.
+    ///
+    /// The table is split into shards by key hash. Lookups of keys already present take no lock: each shard
+    /// publishes an open-addressing array of key pointers through an atomic. Inserting a new key locks only its
+    /// shard. A key lives as long as its table; pointers to it never change. Arrays replaced when a shard grows are
+    /// kept until the table dies, since a reader may still be probing them, which at most doubles the slot memory.
+    ///
+    /// Every object holds on to the table its keys come from (see retain()), so a table owned by a std::shared_ptr
+    /// is freed with the last document using it. Parsers create a table of their own unless ParseOptions names one;
+    /// pass a shared table, such as global(), to parsers that see the same keys over and over.
+    struct KeyTable : std::enable_shared_from_this<KeyTable> {
+    protected:
+        struct Slots {
+            size_t mask;
+            std::unique_ptr<std::atomic<const Key*>[]> slots;
+        };
+
+        struct Shard {
+            std::atomic<const Slots*> current{nullptr}; // Allocated with the first key
+            mutable std::mutex mutex; // Guards everything below
+            std::vector<std::unique_ptr<Key>> keys;
+            std::vector<std::unique_ptr<Slots>> generations;
+        };
+
+        static constexpr size_t SHARD_BITS = 4;
+        static constexpr size_t SHARD_COUNT = size_t{1} << SHARD_BITS;
+        static constexpr size_t INITIAL_SLOTS = 64;
+
+        std::array<Shard, SHARD_COUNT> shards_;
+        std::atomic<size_t> size_{0};
+
+        Shard& shard_for(size_t hash);
+        [[nodiscard]] const Shard& shard_for(size_t hash) const;
+        static const Key* probe(const Slots& slots, std::string_view text, size_t hash);
+        static void place(const Slots& slots, const Key* key);
+
+    public:
+        KeyTable();
+        KeyTable(const KeyTable&) = delete;
+        KeyTable& operator=(const KeyTable&) = delete;
+        ~KeyTable();
+
+        /// The process-wide table, for keys shared by every parser that opts in. It is never destroyed, so the pointer
+        /// owns nothing and copying it costs no reference count; nor are its keys ever freed, so keep it for trusted
+        /// key sets.
+        static const std::shared_ptr<KeyTable>& global();
+
+        /// A pointer that keeps this table alive if a std::shared_ptr owns it, and otherwise, as for global() or a
+        /// table the caller owns directly, merely refers to it.
+        std::shared_ptr<KeyTable> retain();
+
+        /// The key equal to `text`, added first if it is not in the table yet.
+        const Key* intern(std::string_view text);
+        /// The key equal to `text`, or nullptr. Never locks.
+        [[nodiscard]] const Key* find(std::string_view text) const;
+        /// Number of keys interned so far.
+        [[nodiscard]] size_t size() const;
+    };
+} // namespace choochoo::json
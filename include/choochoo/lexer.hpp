@@ -2,27 +2,34 @@
 #include <cctype>
 #include <istream>
 #include <string_view>
+#include <utility>
 #include <vector>
+#include "choochoo/error.hpp"
 #include "choochoo/token.hpp"
 
 namespace choochoo::json {
     struct Lexer {
     protected:
-        // For string input
+        // The bytes being lexed: the whole string input, or the filled part of the stream buffer
         std::string_view input_;
         size_t position_{}, line_{}, column_{};
 
-        // For stream input
+        // For stream input: blocks are read into stream_buffer_ and lexed in place. On refill only the bytes from
+        // token_start_ onwards are kept, so a token straddling two blocks is the only thing ever copied.
         std::istream* input_stream_{nullptr};
-        static constexpr size_t STREAM_BUFFER_SIZE = 8;
-        char stream_buffer_[STREAM_BUFFER_SIZE]{};
-        size_t stream_head_{0}, stream_tail_{0}, stream_count_{0};
+        std::vector<char> stream_buffer_;
+        size_t stream_block_size_{DEFAULT_STREAM_BLOCK_SIZE};
+        size_t stream_offset_{0}; // Stream offset of stream_buffer_[0]
+        size_t token_start_{0};
+        size_t previous_end_{0}; // Input offset where next_token() started looking, just past the token before
+        bool retain_buffer_{false}; // Set by tokenize(): keep every byte read so far so earlier tokens stay valid
         bool using_stream_{false};
-        size_t stream_line_{1}, stream_column_{1};
+        ErrorCode invalid_reason_{ErrorCode::UNEXPECTED_CHARACTER}; // Why the last INVALID token was produced
 
-        [[nodiscard]] char current_char() const;
+        [[nodiscard]] char current_char();
         [[nodiscard]] char peek_char(size_t offset = 1);
         void advance();
+        bool refill();
         void skip_whitespace();
         [[nodiscard]] Token make_token(token::Type type, size_t start_pos, size_t length) const;
         Token scan_string();
@@ -30,10 +37,42 @@ namespace choochoo::json {
         Token scan_keyword();
 
     public:
+        static constexpr size_t DEFAULT_STREAM_BLOCK_SIZE = 64 * 1024;
+
         explicit Lexer(std::string_view input);
-        explicit Lexer(std::istream& input);
+        /// Lex a stream, reading it `block_size` bytes at a time.
+        explicit Lexer(std::istream& input, size_t block_size = DEFAULT_STREAM_BLOCK_SIZE);
+
+        /// Start over on the string `input`. The stream buffer, if any, keeps its capacity for a later stream.
+        void reset(std::string_view input);
 
+        /// The next token. For stream input its payload views the block buffer and is invalidated by the next call.
         Token next_token();
+        /// All tokens up to EOF or the first invalid one. Payloads stay valid while the lexer is not used further.
         std::vector<Token> tokenize();
+
+        /// Build the token starting at `offset` of the string input, as found by a StructuralIndex. `end` is the
+        /// offset of the following structural character, which for a string is its closing quote, and `has_escapes`
+        /// whether the index saw a backslash in that string. Tokens built this way carry no line/column; use
+        /// `locate()` to recover them.
+        Token index_token(size_t offset, size_t end, bool has_escapes);
+
+        /// Line and column (both 1-based) of a byte offset into the string input.
+        [[nodiscard]] std::pair<size_t, size_t> locate(size_t offset) const;
+
+        /// Input offset just past the token returned before the most recent one, which for a parser holding one
+        /// token of lookahead is where the value it just finished ends. Only kept by next_token().
+        [[nodiscard]] size_t previous_token_end() const;
+
+        /// Skip the rest of the current line, up to and including its newline, e.g. to resume after a malformed
+        /// line of newline-delimited JSON.
+        void skip_line();
+
+        /// Why the most recent INVALID token was rejected: UNTERMINATED_STRING, INVALID_NUMBER, INVALID_LITERAL or
+        /// UNEXPECTED_CHARACTER.
+        [[nodiscard]] ErrorCode invalid_reason() const;
+
+        /// Whether the input is read from a stream, so token payloads only live as long as the current block.
+        [[nodiscard]] bool is_streaming() const;
     };
 } // namespace choochoo::json
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace choochoo::json::number {
+    /// Convert a JSON number (RFC 8259 grammar, the whole of `text`) to the nearest double. Never allocates or throws;
+    /// returns std::nullopt for malformed text and for magnitudes too large for a double. Magnitudes too small for one
+    /// round to a subnormal or a signed zero, as with strtod.
+    [[nodiscard]] std::optional<double> parse_double(std::string_view text);
+
+    /// Convert a JSON integer (no fraction or exponent) that fits in an int64_t.
+    [[nodiscard]] std::optional<int64_t> parse_int64(std::string_view text);
+} // namespace choochoo::json::number
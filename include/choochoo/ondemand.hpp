@@ -0,0 +1,194 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "choochoo/error.hpp"
+#include "choochoo/parser.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json::ondemand {
+    /// On-demand navigation: cursors over the raw input that only parse what is read and skip the rest, so pulling a
+    /// few fields out of a large document never builds a tree.
+    ///
+    /// Cursors are a few pointers into the input, which must outlive them. Navigation does not fail eagerly: a lookup
+    /// on a missing field or a value of the wrong type yields a cursor carrying the error, which the getter at the end
+    /// of the chain reports, so `document["user"]["id"].get_int64()` needs a single check. Errors are located in the
+    /// whole document, also those of materialize() and of decoding escapes. Skipped values are only checked for
+    /// terminated strings without raw control characters and balanced brackets.
+
+    struct Array;
+    struct Object;
+
+    struct Value {
+    protected:
+        const char* begin_{}; // Start of the document, for error locations
+        const char* end_{};
+        const char* pos_{};                // First byte of the value, or where the error was found
+        std::optional<ErrorCode> error_{}; // Set on a failed cursor
+
+        Value(const char* begin, const char* end, const char* pos, std::optional<ErrorCode> error = std::nullopt);
+
+        friend struct Array;
+        friend struct Document;
+        friend struct Field;
+        friend struct Object;
+
+    public:
+        Value() = default;
+
+        /// False for a cursor carrying an error.
+        [[nodiscard]] bool valid() const;
+        /// The error carried by the cursor, with its line and column, if any.
+        [[nodiscard]] std::optional<Error> error() const;
+
+        /// The type of the value, judged from its first byte.
+        [[nodiscard]] std::expected<Type, Error> type() const;
+
+        [[nodiscard]] std::expected<int64_t, Error> get_int64() const;
+        [[nodiscard]] std::expected<double, Error> get_double() const;
+        [[nodiscard]] std::expected<bool, Error> get_bool() const;
+        [[nodiscard]] std::expected<bool, Error> is_null() const;
+        /// The string with its escapes decoded.
+        [[nodiscard]] std::expected<std::string, Error> get_string() const;
+        /// The string body exactly as written in the input, escapes included. Never copies.
+        [[nodiscard]] std::expected<std::string_view, Error> get_raw_string() const;
+
+        [[nodiscard]] Array get_array() const;
+        [[nodiscard]] Object get_object() const;
+
+        /// Member `name` of an object value.
+        [[nodiscard]] Value find_field(std::string_view name) const;
+        [[nodiscard]] Value operator[](std::string_view name) const;
+        /// Element `index` of an array value.
+        [[nodiscard]] Value at(size_t index) const;
+
+        /// The text of the whole value, skipping over it without parsing its contents.
+        [[nodiscard]] std::expected<std::string_view, Error> raw_json() const;
+        /// Parse the value into a json::Value tree.
+        [[nodiscard]] std::expected<json::Value, Error> materialize(ParseOptions options = {}) const;
+    };
+
+    /// A member met while iterating over an object.
+    struct Field {
+        std::string_view key; // As written in the input, escapes included
+        Value value;
+
+        /// The key with its escapes decoded.
+        [[nodiscard]] std::expected<std::string, Error> unescaped_key() const;
+    };
+
+    struct Array {
+    protected:
+        const char* begin_{};
+        const char* end_{};
+        const char* first_{}; // First element or the closing bracket, or where the error was found
+        std::optional<ErrorCode> error_{};
+
+        Array(const char* begin, const char* end, const char* first, std::optional<ErrorCode> error = std::nullopt);
+
+        friend struct Value;
+
+    public:
+        /// Forward-only: advancing skips whatever of the current element was not read.
+        struct iterator {
+        protected:
+            const char* begin_{};
+            const char* end_{};
+            const char* pos_{}; // nullptr once past the end
+            std::optional<ErrorCode> error_{};
+
+            iterator(const char* begin, const char* end, const char* pos, std::optional<ErrorCode> error);
+
+            friend struct Array;
+
+        public:
+            iterator() = default;
+
+            Value operator*() const;
+            iterator& operator++();
+            bool operator==(const iterator& other) const;
+        };
+
+        [[nodiscard]] bool valid() const;
+        [[nodiscard]] std::optional<Error> error() const;
+
+        /// Element `index`, skipping the ones before it.
+        [[nodiscard]] Value at(size_t index) const;
+        /// Number of elements, skipping over all of them.
+        [[nodiscard]] std::expected<size_t, Error> count() const;
+
+        /// A failed array yields one element carrying its error.
+        [[nodiscard]] iterator begin() const;
+        [[nodiscard]] iterator end() const;
+    };
+
+    struct Object {
+    protected:
+        const char* begin_{};
+        const char* end_{};
+        const char* first_{};  // First member or the closing brace, or where the error was found
+        const char* resume_{}; // Where the next lookup starts: the member after the last one found
+        std::optional<ErrorCode> error_{};
+
+        Object(const char* begin, const char* end, const char* first, std::optional<ErrorCode> error = std::nullopt);
+
+        friend struct Value;
+
+    public:
+        /// Forward-only: advancing skips whatever of the current member's value was not read.
+        struct iterator {
+        protected:
+            const char* begin_{};
+            const char* end_{};
+            const char* pos_{}; // Key of the current member; nullptr once past the end
+            std::optional<ErrorCode> error_{};
+            Field field_;
+
+            iterator(const char* begin, const char* end, const char* pos, std::optional<ErrorCode> error);
+            void read_member();
+
+            friend struct Object;
+
+        public:
+            iterator() = default;
+
+            const Field& operator*() const;
+            const Field* operator->() const;
+            iterator& operator++();
+            bool operator==(const iterator& other) const;
+        };
+
+        [[nodiscard]] bool valid() const;
+        [[nodiscard]] std::optional<Error> error() const;
+
+        /// Member `name`. Lookups start after the member found last and wrap around, so reading fields in document
+        /// order scans the object once.
+        [[nodiscard]] Value find_field(std::string_view name);
+        [[nodiscard]] Value operator[](std::string_view name);
+
+        /// A failed object yields one member carrying its error.
+        [[nodiscard]] iterator begin() const;
+        [[nodiscard]] iterator end() const;
+    };
+
+    /// A JSON text to navigate on demand. Holds a view of the input, which must outlive the document and every cursor
+    /// taken from it; for a file, open it with MappedFile::open() and keep that alive.
+    struct Document {
+    protected:
+        std::string_view source_;
+
+    public:
+        explicit Document(std::string_view source);
+
+        /// The root value. Anything after it is not looked at.
+        [[nodiscard]] Value root() const;
+
+        [[nodiscard]] Value find_field(std::string_view name) const;
+        [[nodiscard]] Value operator[](std::string_view name) const;
+        [[nodiscard]] Value at(size_t index) const;
+
+        [[nodiscard]] std::string_view source() const;
+    };
+} // namespace choochoo::json::ondemand
@@ -0,0 +1,40 @@
+#pragma once
+#include <expected>
+#include <memory>
+#include <string_view>
+#include "choochoo/error.hpp"
+#include "choochoo/key.hpp"
+#include "choochoo/lexer.hpp"
+#include "choochoo/parser.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    /// A Lexer and Parser kept alive to parse one document after another, so nothing is set up per document: the
+    /// parser keeps its stack, keys stay interned in its KeyTable until a table of its own fills up (see
+    /// PRIVATE_KEY_TABLE_LIMIT), and arrays and objects of earlier results handed back through parse_into() or
+    /// recycle() are refilled instead of allocated.
+    ///
+    /// The options apply to every parse; with ParseOptions::zero_copy_strings each input must outlive its result.
+    /// A context is used by one thread at a time.
+    struct ParseContext {
+    protected:
+        Lexer lexer_;
+        Parser parser_; // Reads lexer_
+
+    public:
+        explicit ParseContext(ParseOptions options = {});
+        ParseContext(const ParseContext&) = delete;
+        ParseContext& operator=(const ParseContext&) = delete;
+
+        /// The value spanning the whole of `json`.
+        std::expected<Value, Error> parse(std::string_view json);
+        /// Parse `json` into `out`, first recycling the tree `out` holds, so parsing into the same Value every time
+        /// reuses the capacity of the previous document. On failure `out` is null.
+        std::expected<void, Error> parse_into(std::string_view json, Value& out);
+        /// Destroy a result, keeping its containers for the next parses.
+        void recycle(Value&& tree);
+
+        /// The table the keys of the next parsed objects will live in.
+        [[nodiscard]] const std::shared_ptr<KeyTable>& key_table() const;
+    };
+} // namespace choochoo::json
@@ -1,33 +1,125 @@
 #pragma once
 #include <expected>
 #include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_set>
+#include <vector>
+#include "choochoo/error.hpp"
+#include "choochoo/key.hpp"
 #include "choochoo/lexer.hpp"
+#include "choochoo/structural_index.hpp"
 #include "choochoo/token.hpp"
 #include "choochoo/value.hpp"
 
 namespace choochoo::json {
+    /// Decode the backslash escapes of a raw (unquoted) JSON string. An Error's offset is relative to `raw_string`
+    /// and it has no line or column.
+    std::expected<std::string, Error> unescape(std::string_view raw_string);
+    /// As above, allocating the result from `resource`.
+    std::expected<String, Error> unescape(std::string_view raw_string, std::pmr::memory_resource* resource);
+    /// As above, replacing the contents of `out` so its capacity is reused across strings.
+    std::expected<void, Error> unescape(std::string_view raw_string, std::string& out);
+
+    inline constexpr size_t DEFAULT_MAX_DEPTH = 1024;
+    /// Keys a parser's own key table may hold before the parser starts the next document with a fresh one.
+    inline constexpr size_t PRIVATE_KEY_TABLE_LIMIT = 1 << 16;
+
+    struct ParseOptions {
+        /// Backs every string, array and object of the parsed tree; nullptr means std::pmr::get_default_resource().
+        /// Pass an arena such as std::pmr::monotonic_buffer_resource to build and release a document in bulk. The
+        /// tree must not outlive it.
+        std::pmr::memory_resource* memory_resource{nullptr};
+        /// Interns object keys. Parsed objects keep their table alive, so its keys are freed with the last tree using
+        /// them. nullptr gives the parser a table of its own, swapped for a fresh one between documents once it holds
+        /// PRIVATE_KEY_TABLE_LIMIT keys. Share a table, such as KeyTable::global(), between parsers that see the same
+        /// keys over and over.
+        std::shared_ptr<KeyTable> key_table{};
+        /// Store strings without escapes as views into the input instead of copying them (see
+        /// Value::borrowed_string), so the input must outlive the tree. Ignored for stream input, whose buffer is
+        /// reused.
+        bool zero_copy_strings{false};
+        /// Deepest nesting of arrays and objects accepted; deeper input fails cleanly with an error. Parser and
+        /// FusedParser keep open containers on an explicit stack, so any limit is safe for the thread's stack.
+        size_t max_depth{DEFAULT_MAX_DEPTH};
+    };
+
     struct Parser {
     private:
         std::reference_wrapper<Lexer> lexer_;
         Token current_token_;
-        std::unordered_set<std::string> key_pool_; // For string interning of object keys
+        bool owns_key_table_;                 // No ParseOptions::key_table was given
+        std::shared_ptr<KeyTable> key_table_; // For string interning of object keys
+        std::pmr::memory_resource* resource_;
+        bool zero_copy_requested_; // ParseOptions::zero_copy_strings
+        bool zero_copy_strings_;   // ...and the lexer's input is not a stream
+        size_t max_depth_;
+
+        /// An array or object still being filled, with the key of the member whose value is being parsed.
+        struct Frame {
+            bool is_object;
+            Array array;
+            Object object;
+            const Key* key{nullptr};
+        };
+        std::vector<Frame> stack_; // Open containers, innermost last; kept between parses to reuse its capacity
+        ContainerPool pool_;       // Emptied containers, taken before allocating new ones
+
+        // Index-driven mode: tokens come from the structural offsets instead of Lexer::next_token()
+        const StructuralIndex* index_{nullptr};
+        size_t index_pos_{0};
+
+        /// An error at the current token.
+        [[nodiscard]] Error error_here(ErrorCode code);
+        /// An error in the escapes of the current string token, located within it.
+        [[nodiscard]] Error error_in_string(const Error& unescape_error);
+        /// Open a container whose opening bracket was just consumed. True if it was empty and is already closed into
+        /// `value`; otherwise it is pushed on stack_.
+        bool begin_container(bool is_object, Value& value);
+        /// Parse a value, or with `opened` the rest of a container whose opening bracket was consumed, without
+        /// recursing.
+        std::expected<Value, Error> parse_nested(std::optional<token::Type> opened);
+        /// Empty every open container on stack_ into pool_ after a failed parse.
+        void abandon_stack();
+        /// Between documents, replace a full table of the parser's own so its keys go with the trees using them.
+        void renew_key_table();
 
     public:
         Token current_token();
         void advance();
-        std::expected<void, std::string> expect(token::Type expected);
-        std::expected<std::string, std::string> process_string(std::string_view raw_string);
-        double process_number(std::string_view number_str);
+        std::expected<void, Error> expect(token::Type expected);
+        std::expected<std::string, Error> process_string(std::string_view raw_string);
+        std::optional<double> process_number(std::string_view number_str);
+
+        std::expected<Value, Error> parse_value();
+        std::expected<Value, Error> parse_object_body();
+        std::expected<Value, Error> parse_array_body();
+
+        explicit Parser(Lexer& lexer, ParseOptions options = {});
+        /// Parse the lexer's string input by walking a prebuilt structural index.
+        Parser(Lexer& lexer, const StructuralIndex& index, ParseOptions options = {});
 
-        std::expected<Value, std::string> parse_value();
-        std::expected<Value, std::string> parse_object_body();
-        std::expected<Value, std::string> parse_array_body();
+        /// The value spanning the whole input. Failures are reported as an Error, whose message() is only formatted
+        /// on request, so rejecting malformed input does not allocate.
+        std::expected<Value, Error> parse();
+        /// The next of several values in the input, such as newline-delimited JSON, leaving the parser on whatever
+        /// follows it. Fails with UNEXPECTED_EOF once the input is used up; see at_end().
+        std::expected<Value, Error> parse_next();
+        /// Whether only whitespace is left.
+        [[nodiscard]] bool at_end() const;
 
-        explicit Parser(Lexer& lexer);
+        /// Start over on whatever the lexer now holds, e.g. after Lexer::reset(), walking the lexer's tokens. The
+        /// parser keeps its options, stack and container pool.
+        void reset();
+        /// As above, walking a structural index of the lexer's new input.
+        void reset(const StructuralIndex& index);
+        /// Destroy `tree`, keeping its arrays and objects to fill while parsing the next documents instead of
+        /// allocating new ones (see Value::recycle()).
+        void recycle(Value&& tree);
 
-        std::expected<Value, std::string> parse();
+        /// The table the keys of the next parsed objects will live in.
+        [[nodiscard]] const std::shared_ptr<KeyTable>& key_table() const;
     };
 } // namespace choochoo::json
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "choochoo/error.hpp"
+#include "choochoo/key.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    /// A compiled query into a Value tree, from an RFC 6901 JSON Pointer (`/user/tags/0`) or a dotted path
+    /// (`user.tags[0]`).
+    ///
+    /// Compiling interns every member name in a KeyTable and parses every array index up front, so find() never
+    /// allocates, hashes or parses: it indexes arrays and looks members up by key, comparing pointers in objects
+    /// whose keys share the path's table and the stored hash and text in any other. Compile a path once and reuse it
+    /// for every document. Without a table the path interns its names in a private one, so arbitrary paths never
+    /// grow a shared table; pass the table the documents are parsed with to match by pointer.
+    struct Path {
+    protected:
+        static constexpr size_t NO_INDEX = static_cast<size_t>(-1);
+
+        /// One reference token. A token like `0` can name an object member or an array element, so it carries both.
+        struct Step {
+            const Key* key;  // nullptr for `[n]` steps of a dotted path
+            size_t index;    // NO_INDEX if the token is not an array index
+        };
+
+        std::vector<Step> steps_;
+        std::shared_ptr<KeyTable> key_table_; // Keeps the step keys alive
+
+        explicit Path(std::shared_ptr<KeyTable> key_table);
+        void add_step(std::string_view token, bool may_be_index);
+
+    public:
+        /// Compile a JSON Pointer: empty for the root, otherwise `/`-separated tokens with `~1` for `/` and `~0` for
+        /// `~`.
+        static std::expected<Path, Error> pointer(std::string_view pointer,
+                                                  std::shared_ptr<KeyTable> key_table = nullptr);
+        /// Compile a dotted path: member names separated by `.`, each followed by any number of `[n]` indices. Names
+        /// cannot contain `.` or `[`; use a pointer for those. A malformed path fails with the position of the fault
+        /// as its offset.
+        static std::expected<Path, Error> dotted(std::string_view path, std::shared_ptr<KeyTable> key_table = nullptr);
+
+        /// The value the path leads to from `root`, or nullptr if a member or element along it is missing.
+        [[nodiscard]] const Value* find(const Value& root) const;
+        /// As above, for modifying the value found. Copy-on-write containers along the path are unshared first.
+        [[nodiscard]] Value* find(Value& root) const;
+
+        /// Number of reference tokens; 0 for the root.
+        [[nodiscard]] size_t size() const;
+    };
+} // namespace choochoo::json
@@ -0,0 +1,193 @@
+#pragma once
+#include <concepts>
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <vector>
+#include "choochoo/error.hpp"
+#include "choochoo/lexer.hpp"
+#include "choochoo/number.hpp"
+#include "choochoo/parser.hpp"
+#include "choochoo/token.hpp"
+
+namespace choochoo::json::sax {
+    /// How a parse that found no syntax error ended.
+    enum class Status : uint8_t {
+        COMPLETE, // The whole document was read
+        STOPPED   // A handler event returned false
+    };
+
+    /// Receives the parse as a sequence of events. Every event returns true to continue or false to stop the parse
+    /// right there. String and key views are only valid during the call: they point into the input, the lexer's
+    /// stream block or a scratch buffer for strings with escapes, so copy what you keep.
+    template <typename H>
+    concept Handler = requires(H& handler, std::string_view text, double number, bool boolean) {
+        { handler.on_null() } -> std::convertible_to<bool>;
+        { handler.on_bool(boolean) } -> std::convertible_to<bool>;
+        { handler.on_number(number) } -> std::convertible_to<bool>;
+        { handler.on_string(text) } -> std::convertible_to<bool>;
+        { handler.on_key(text) } -> std::convertible_to<bool>;
+        { handler.on_start_object() } -> std::convertible_to<bool>;
+        { handler.on_end_object() } -> std::convertible_to<bool>;
+        { handler.on_start_array() } -> std::convertible_to<bool>;
+        { handler.on_end_array() } -> std::convertible_to<bool>;
+    };
+
+    /// Ignores every event. Derive from it and define only the events you care about.
+    struct BaseHandler {
+        bool on_null() { return true; }
+        bool on_bool(bool) { return true; }
+        bool on_number(double) { return true; }
+        bool on_string(std::string_view) { return true; }
+        bool on_key(std::string_view) { return true; }
+        bool on_start_object() { return true; }
+        bool on_end_object() { return true; }
+        bool on_start_array() { return true; }
+        bool on_end_array() { return true; }
+    };
+
+    namespace detail {
+        enum class Scope : uint8_t { ARRAY, OBJECT };
+
+        /// An error at `token`.
+        Error error_at(const Token& token, ErrorCode code);
+        /// An error from unescape() on the string `token`, located within it.
+        Error error_in_string(const Token& token, const Error& unescape_error);
+        /// The error for a token where a value was required.
+        Error no_value_at(const Lexer& lexer, const Token& token);
+    } // namespace detail
+
+    /// Drive `handler` with the tokens of `lexer`, without building any Value. Nesting is tracked on an explicit
+    /// stack, so depth is bounded by memory rather than by the call stack. Events already delivered before a syntax
+    /// error stay delivered.
+    template <Handler H>
+    std::expected<Status, Error> parse(Lexer& lexer, H& handler) {
+        std::vector<detail::Scope> scopes;
+        std::string decoded; // Strings with escapes, reusing its capacity
+
+        const auto text_of = [&decoded](const Token& token) -> std::expected<std::string_view, Error> {
+            if (!token.has_escapes) {
+                return token.value;
+            }
+            if (auto result = unescape(token.value, decoded); !result) {
+                return std::unexpected(detail::error_in_string(token, result.error()));
+            }
+            return std::string_view(decoded);
+        };
+
+        Token token = lexer.next_token();
+        bool expect_key = false;
+        while (true) {
+            if (expect_key) {
+                if (token.type_ == token::Type::INVALID) {
+                    return std::unexpected(detail::error_at(token, lexer.invalid_reason()));
+                }
+                if (token.type_ != token::Type::STRING) {
+                    return std::unexpected(detail::error_at(token, ErrorCode::EXPECTED_KEY));
+                }
+                const auto key = text_of(token);
+                if (!key) {
+                    return std::unexpected(key.error());
+                }
+                if (!handler.on_key(key.value())) {
+                    return Status::STOPPED;
+                }
+                token = lexer.next_token();
+                if (token.type_ != token::Type::COLON) {
+                    return std::unexpected(detail::error_at(token, ErrorCode::EXPECTED_COLON));
+                }
+                token = lexer.next_token();
+                expect_key = false;
+            }
+
+            // A value starts at `token`
+            bool proceed = true;
+            switch (token.type_) {
+            case token::Type::STRING: {
+                const auto text = text_of(token);
+                if (!text) {
+                    return std::unexpected(text.error());
+                }
+                proceed = handler.on_string(text.value());
+                break;
+            }
+            case token::Type::NUMBER: {
+                const auto number = number::parse_double(token.value);
+                if (!number) {
+                    return std::unexpected(detail::error_at(token, ErrorCode::INVALID_NUMBER));
+                }
+                proceed = handler.on_number(*number);
+                break;
+            }
+            case token::Type::TRUE:
+            case token::Type::FALSE:
+                proceed = handler.on_bool(token.type_ == token::Type::TRUE);
+                break;
+            case token::Type::NULL_VALUE:
+                proceed = handler.on_null();
+                break;
+            case token::Type::LBRACE:
+                if (!handler.on_start_object()) {
+                    return Status::STOPPED;
+                }
+                token = lexer.next_token();
+                if (token.type_ == token::Type::RBRACE) {
+                    proceed = handler.on_end_object();
+                    break;
+                }
+                scopes.push_back(detail::Scope::OBJECT);
+                expect_key = true;
+                continue;
+            case token::Type::LBRACKET:
+                if (!handler.on_start_array()) {
+                    return Status::STOPPED;
+                }
+                token = lexer.next_token();
+                if (token.type_ == token::Type::RBRACKET) {
+                    proceed = handler.on_end_array();
+                    break;
+                }
+                scopes.push_back(detail::Scope::ARRAY);
+                continue;
+            default:
+                return std::unexpected(detail::no_value_at(lexer, token));
+            }
+            if (!proceed) {
+                return Status::STOPPED;
+            }
+            token = lexer.next_token();
+
+            // Close every container the value completed, up to the next element or the end of the document
+            while (true) {
+                if (scopes.empty()) {
+                    if (token.type_ != token::Type::EOF_TOKEN) {
+                        return std::unexpected(detail::error_at(token, ErrorCode::TRAILING_CONTENT));
+                    }
+                    return Status::COMPLETE;
+                }
+                const bool in_object = scopes.back() == detail::Scope::OBJECT;
+                if (token.type_ == token::Type::COMMA) {
+                    token = lexer.next_token();
+                    expect_key = in_object;
+                    break;
+                }
+                if (token.type_ != (in_object ? token::Type::RBRACE : token::Type::RBRACKET)) {
+                    return std::unexpected(detail::error_at(
+                        token, in_object ? ErrorCode::EXPECTED_OBJECT_END : ErrorCode::EXPECTED_ARRAY_END));
+                }
+                scopes.pop_back();
+                if (!(in_object ? handler.on_end_object() : handler.on_end_array())) {
+                    return Status::STOPPED;
+                }
+                token = lexer.next_token();
+            }
+        }
+    }
+
+    /// As above, for a document held in memory.
+    template <Handler H>
+    std::expected<Status, Error> parse(std::string_view json, H& handler) {
+        Lexer lexer(json);
+        return parse(lexer, handler);
+    }
+} // namespace choochoo::json::sax
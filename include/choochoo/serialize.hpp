@@ -0,0 +1,43 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    struct SerializeOptions {
+        /// Spaces per nesting level; 0 writes compact JSON with no whitespace at all.
+        int indent{0};
+    };
+
+    /// Append the JSON text of `value` to `out` in a single pass. Reusing `out` across calls reuses its capacity.
+    ///
+    /// Numbers are written with std::to_chars in their shortest form that reads back as the same double; NaN and
+    /// infinities, which JSON cannot represent, are written as null. Strings are written as UTF-8 with only the
+    /// characters JSON requires escaped.
+    void serialize(const Value& value, std::string& out, SerializeOptions options = {});
+
+    /// As above, writing to `out` through a fixed-size buffer.
+    void serialize(const Value& value, std::ostream& out, SerializeOptions options = {});
+
+    inline constexpr size_t SERIALIZE_CHUNK_SIZE = 64 * 1024;
+
+    /// As above, handing the text to `sink` in chunks of about SERIALIZE_CHUNK_SIZE bytes. Each chunk is only valid
+    /// during the call.
+    void serialize_chunks(const Value& value, const std::function<void(std::string_view)>& sink,
+                          SerializeOptions options = {});
+
+    /// As above, writing to an output iterator. Returns the iterator past the last character written.
+    template <std::output_iterator<char> Out>
+    Out serialize(const Value& value, Out out, SerializeOptions options = {}) {
+        serialize_chunks(
+            value, [&out](std::string_view chunk) { out = std::copy(chunk.begin(), chunk.end(), out); }, options);
+        return out;
+    }
+
+    /// The JSON text of `value` as a new string.
+    [[nodiscard]] std::string dump(const Value& value, SerializeOptions options = {});
+} // namespace choochoo::json
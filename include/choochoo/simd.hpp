@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace choochoo::json::simd {
+    /// Scanning kernels shared by the lexers and writers. Each one processes 16 (SSE2) or 32 (AVX2) bytes per step
+    /// and falls back to a scalar loop for the tail and on other targets.
+
+    /// First byte in [begin, end) that is a quote, a backslash or a control character (below 0x20), or `end`.
+    [[nodiscard]] const char* find_string_special(const char* begin, const char* end);
+
+    /// Append `text` to `out` as a quoted JSON string. Runs without a quote, backslash or control character are found
+    /// with find_string_special() and copied in bulk; only the bytes that need it are escaped, as \" \\ \b \f \n \r
+    /// \t or \u00XX. Bytes from 0x7F up, such as UTF-8 sequences, are copied as they are.
+    void escape_string(std::string& out, std::string_view text);
+
+    /// First byte in [begin, end) that is not JSON whitespace (space, tab, CR, LF), or `end`. Adds the number of
+    /// newlines skipped to `newlines` and, if there were any, points `line_start` just past the last one.
+    [[nodiscard]] const char* skip_whitespace(const char* begin, const char* end, size_t& newlines,
+                                              const char*& line_start);
+} // namespace choochoo::json::simd
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <expected>
+#include <string_view>
+#include <vector>
+#include "choochoo/error.hpp"
+
+namespace choochoo::json {
+    /// Stage-1 index of a complete JSON document.
+    ///
+    /// Records, in input order, the byte offset of every structural character outside of strings (`{ } [ ] : ,`),
+    /// both quotes of every string, any raw control character inside a string (which JSON forbids), and the first
+    /// byte of every scalar (numbers and literals). The index is built 64 bytes at a time with SSE2/AVX2 kernels when
+    /// available, so a Parser constructed over it can jump from token to token instead of lexing the input one
+    /// character at a time. The backslashes found on the way are kept as one bit per opening quote, so strings need
+    /// no second scan for escapes.
+    struct StructuralIndex {
+    protected:
+        std::vector<uint32_t> offsets_;
+        std::vector<uint64_t> escapes_; // Bit per entry of offsets_; only grown as far as the last string with escapes
+
+        void mark_escapes(size_t position);
+
+    public:
+        /// Build the index for `input`. Fails with UNTERMINATED_STRING at the opening quote of a string that never
+        /// closes, or with INPUT_TOO_LARGE for inputs of 4 GiB and more.
+        static std::expected<StructuralIndex, Error> build(std::string_view input);
+
+        [[nodiscard]] const std::vector<uint32_t>& offsets() const;
+        [[nodiscard]] size_t size() const;
+        /// Whether the string opened by the quote at `offsets()[position]` contains a backslash.
+        [[nodiscard]] bool has_escapes(size_t position) const;
+    };
+} // namespace choochoo::json
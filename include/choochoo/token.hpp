@@ -1,7 +1,6 @@
 #pragma once
-#include <string>
 #include <string_view>
-#include <variant>
+#include <type_traits>
 
 namespace choochoo::json {
     namespace token {
@@ -20,12 +19,19 @@ namespace choochoo::json {
             EOF_TOKEN,
             INVALID
         };
-    }
+    } // namespace token
 
+    /// A lexed token. Trivially copyable: `value` is a view into the lexer's input and is empty for punctuation and
+    /// EOF. For stream input the view points into the lexer's block buffer and is only valid until the next call to
+    /// Lexer::next_token().
     struct Token {
         token::Type type_{};
-        std::variant<std::string_view, std::string> value;
+        std::string_view value;
         size_t line{};
         size_t column{};
+        size_t offset{}; // Byte offset of the token in the input
+        bool has_escapes{}; // STRING only: the raw value contains backslash escapes
     };
+
+    static_assert(std::is_trivially_copyable_v<Token>);
 } // namespace choochoo::json
@@ -1,28 +1,151 @@
 #pragma once
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include "choochoo/key.hpp"
 
 namespace choochoo::json {
-    enum class Type { NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+    enum class Type : uint8_t { NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
 
+    struct Value;
+    struct ContainerPool;
+
+    // Every container in a tree allocates from a std::pmr::memory_resource, so a whole document can live in an arena.
+    // Moving a Value keeps its resource; copying one puts the copy in the default resource (see Value).
+    using String = std::pmr::string;
+    using Array = std::pmr::vector<Value>;
+
+    /// Object members, stored contiguously in insertion order.
+    ///
+    /// Keys are interned, so members are matched by key pointer, or by name against the hash stored in each Key. Small
+    /// objects are searched linearly; once an object grows past LINEAR_SEARCH_LIMIT members, emplace() also maintains
+    /// an open-addressing index of member positions keyed by that hash.
+    /// Only emplace() touches the index, so const lookups never mutate and a tree can be read from several threads
+    /// at once. As with std::unordered_map::emplace(), emplacing an existing key leaves the object unchanged.
+    struct Object {
+    public:
+        using value_type = std::pair<const Key*, Value>;
+        using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+        using iterator = std::pmr::vector<value_type>::iterator;
+        using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+        static constexpr size_t LINEAR_SEARCH_LIMIT = 16;
+
+    protected:
+        std::pmr::vector<value_type> members_;
+        std::pmr::vector<uint32_t> index_; // Member position + 1 per slot, 0 for an empty slot; empty while small
+        std::shared_ptr<KeyTable> key_table_; // Where every member's key lives, once one is interned
+
+        [[nodiscard]] size_t find_position(const Key* key) const;
+        [[nodiscard]] size_t find_position(std::string_view name, size_t hash) const;
+        void build_index();
+        [[nodiscard]] const Key* adopt(const Key* key);
+
+    public:
+        Object();
+        explicit Object(std::pmr::memory_resource* resource);
+        ~Object();
+        Object(const Object& other);
+        /// Copy `other` into `resource`.
+        Object(const Object& other, std::pmr::memory_resource* resource);
+        Object(Object&& other) noexcept;
+        Object& operator=(const Object& other);
+        Object& operator=(Object&& other) noexcept;
+
+        [[nodiscard]] allocator_type get_allocator() const;
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] bool empty() const;
+        void reserve(size_t count);
+        /// Remove every member, keeping the capacity.
+        void clear();
+
+        /// Insert `value` under `key` unless the key is already present.
+        ///
+        /// The object keeps the table of the first interned key alive, and stores keys from any other table as that
+        /// table's equal, so every member's key comes from one table.
+        std::pair<iterator, bool> emplace(const Key* key, Value value);
+
+        /// Lookup by key compares pointers when `key` comes from this object's table, and text otherwise.
+        [[nodiscard]] iterator find(const Key* key);
+        [[nodiscard]] const_iterator find(const Key* key) const;
+        [[nodiscard]] bool contains(const Key* key) const;
+        /// Throws std::out_of_range when `key` is not a member.
+        [[nodiscard]] Value& at(const Key* key);
+        [[nodiscard]] const Value& at(const Key* key) const;
+
+        // Lookup by name, hashing `name` once
+        [[nodiscard]] iterator find(std::string_view name);
+        [[nodiscard]] const_iterator find(std::string_view name) const;
+        [[nodiscard]] bool contains(std::string_view name) const;
+        [[nodiscard]] Value& at(std::string_view name);
+        [[nodiscard]] const Value& at(std::string_view name) const;
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+    };
+
+    /// A JSON value in 16 bytes: the type tag, a string length and one 8-byte payload. Booleans and numbers are
+    /// stored inline; arrays and objects live behind a pointer, allocated from the same memory resource as their
+    /// contents. Strings of up to INLINE_STRING_CAPACITY bytes are stored inline, borrowed strings as a pointer into
+    /// someone else's buffer, and the rest behind a pointer like containers.
+    ///
+    /// Copies are copy-on-write: an array or object already in the default resource is shared by reference count,
+    /// so copying a whole parsed document or handing a subtree to another component is O(1). Non-const access to a
+    /// shared container (as_object(), find(), at(), begin(), ...) first gives this value its own copy of it, one level
+    /// deep. Take references that way only after the last copy of the value: a reference taken before a copy still
+    /// points into the container the two now share, so writing through it changes the copy as well. Non-const access
+    /// after the copy gives this value a container of its own again and leaves such a reference with the copy. Other
+    /// containers, such as those in an arena, and containers holding borrowed strings are copied deeply into the
+    /// default resource, so a copy never depends on anything a deep copy would not.
+    /// Shared containers may be read and copied from several threads at once.
     struct Value {
+    public:
+        static constexpr size_t INLINE_STRING_CAPACITY = 8;
+
     protected:
+        enum class StringKind : uint8_t { OWNED, BORROWED, INLINE };
+
         Type type_{};
+        StringKind string_kind_{};
+        uint32_t string_length_{}; // BORROWED and INLINE strings
+
+        template <typename T>
+        struct Shared; // A reference-counted container
 
         union Storage {
             bool boolean{};
             double number;
-            std::string string;
-            std::unordered_map<const std::string*, Value> object;
-            std::vector<Value> array;
-
-            Storage() {}
-            ~Storage() {}
+            String* string;
+            const char* borrowed;
+            char inline_chars[INLINE_STRING_CAPACITY];
+            Shared<Object>* object;
+            Shared<Array>* array;
         } storage_{};
 
+        void set_inline_string(std::string_view s);
+        /// Whether the value refers to a borrowed string anywhere in it.
+        [[nodiscard]] bool borrows() const;
+        /// Work out, and cache in every container on the way, whether the array or object `storage` holds a borrowed
+        /// string anywhere, without recursion.
+        static bool scan_borrows(Type type, Storage storage);
+        /// Give this value a container of its own before it is modified.
+        void unshare();
+        /// Whether a copy of this array or object can share its container rather than copy it.
+        [[nodiscard]] bool shareable() const;
+        /// A deep copy of the array or object `source` in `resource`, built without recursion.
+        static Value deep_copy(const Value& source, std::pmr::memory_resource* resource);
+        /// Drop a reference to the container of an array or object. Whatever that frees is torn down without
+        /// recursion, so destroying a deeply nested tree does not use the call stack.
+        static void release(Type type, Storage storage) noexcept;
+
     public:
         Value();
         ~Value();
@@ -34,38 +157,70 @@ namespace choochoo::json {
         static Value null();
         static Value boolean(const bool b);
         static Value number(const double n);
-        static Value string(std::string s = "");
-        static Value array(std::vector<Value> arr = {});
-        static Value object(std::unordered_map<const std::string*, Value> obj = {});
+        static Value string(String s = {});
+        /// Copy `s` into a string allocated from `resource`, or inline if it is short enough.
+        static Value string(std::string_view s, std::pmr::memory_resource* resource);
+        /// A string that refers to `s` instead of copying it, so the bytes behind `s` must outlive the value and
+        /// everything it is moved into. Copies of the value own their text.
+        static Value borrowed_string(std::string_view s);
+        static Value array(Array arr = {});
+        static Value object(Object obj = {});
+
+        /// Destroy `tree`, moving every array and object it alone owns in `pool.resource` into `pool`, emptied but
+        /// with its capacity, instead of freeing it. Shared containers and those from other resources are released
+        /// as usual. Like destruction, this does not recurse.
+        static void recycle(Value&& tree, ContainerPool& pool);
 
         [[nodiscard]] Type type() const;
 
         [[nodiscard]] std::optional<double> as_number() const;
         [[nodiscard]] std::optional<bool> as_boolean() const;
-        [[nodiscard]] std::optional<std::reference_wrapper<const std::string>> as_string() const;
-        [[nodiscard]] std::optional<std::reference_wrapper<const std::vector<Value>>> as_array();
-        [[nodiscard]] std::optional<std::reference_wrapper<std::unordered_map<const std::string*, Value>>> as_object();
+        [[nodiscard]] std::optional<std::string_view> as_string() const;
+        [[nodiscard]] std::optional<std::reference_wrapper<const Array>> as_array();
+        [[nodiscard]] std::optional<std::reference_wrapper<Object>> as_object();
 
         // Const-qualified overloads for read-only access
-        [[nodiscard]] std::optional<std::reference_wrapper<const std::vector<Value>>> as_array() const;
-        [[nodiscard]] std::optional<std::reference_wrapper<const std::unordered_map<const std::string*, Value>>>
-        as_object() const;
+        [[nodiscard]] std::optional<std::reference_wrapper<const Array>> as_array() const;
+        [[nodiscard]] std::optional<std::reference_wrapper<const Object>> as_object() const;
+
+        // --- Member lookup ---
+
+        /// The member named `name`, or nullptr if there is none or this is not an object.
+        [[nodiscard]] Value* find(std::string_view name);
+        [[nodiscard]] const Value* find(std::string_view name) const;
+        /// The member named `name`. Throws std::logic_error if this is not an object and std::out_of_range if there
+        /// is no such member.
+        [[nodiscard]] Value& at(std::string_view name);
+        [[nodiscard]] const Value& at(std::string_view name) const;
+        /// The member named `name`, or a null Value if there is none or this is not an object, so lookups chain:
+        /// `root["user"]["name"]`.
+        const Value& operator[](std::string_view name) const;
 
-        /// Pretty print the value as JSON
+        /// Pretty print the value as JSON, two spaces per level; same as dump() with an indent of 2. Lines after the
+        /// first are shifted right by `indent` spaces.
         std::string pretty(int indent = 0) const;
 
         // --- Iterator support ---
 
         // Array iterators
-        std::vector<Value>::iterator begin();
-        std::vector<Value>::iterator end();
-        std::vector<Value>::const_iterator begin() const;
-        std::vector<Value>::const_iterator end() const;
+        Array::iterator begin();
+        Array::iterator end();
+        Array::const_iterator begin() const;
+        Array::const_iterator end() const;
 
         // Object iterators
-        std::unordered_map<const std::string*, Value>::iterator obj_begin();
-        std::unordered_map<const std::string*, Value>::iterator obj_end();
-        std::unordered_map<const std::string*, Value>::const_iterator obj_begin() const;
-        std::unordered_map<const std::string*, Value>::const_iterator obj_end() const;
+        Object::iterator obj_begin();
+        Object::iterator obj_end();
+        Object::const_iterator obj_begin() const;
+        Object::const_iterator obj_end() const;
+    };
+
+    static_assert(sizeof(Value) <= 16, "Value must stay two words wide");
+
+    /// Empty arrays and objects that keep their capacity, for building the next tree without allocating.
+    struct ContainerPool {
+        std::pmr::memory_resource* resource{std::pmr::get_default_resource()}; // Every pooled container uses it
+        std::vector<Array> arrays;
+        std::vector<Object> objects;
     };
 } // namespace choochoo::json
@@ -0,0 +1,101 @@
+#pragma once
+#include <concepts>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "choochoo/serialize.hpp"
+#include "choochoo/value.hpp"
+
+namespace choochoo::json {
+    /// Streaming JSON writer: encodes begin_object()/key()/value()/end_array()/... calls straight into its output, so
+    /// documents of any size can be produced without building a Value tree.
+    ///
+    /// Output goes to a caller's std::string, which just grows, or through a buffer of about SERIALIZE_CHUNK_SIZE
+    /// bytes to a chunk callback, a file descriptor or a std::ostream. Apart from that buffer, memory use grows only
+    /// with nesting depth. Formatting follows serialize(): shortest round-trip numbers, minimal escaping, and
+    /// SerializeOptions::indent.
+    ///
+    /// Debug builds (without NDEBUG) check that the calls form a single well-formed value and throw std::logic_error
+    /// at the first one that does not: a key outside an object, a value where a key is due, a mismatched end, or a
+    /// second root. Release builds trust the caller. finish() always reports an incomplete document.
+    struct Writer {
+    protected:
+        enum class Scope : uint8_t { ARRAY, OBJECT };
+
+        std::string buffer_;
+        std::string& out_; // buffer_ unless writing to a caller's string
+        std::function<void(std::string_view)> sink_;
+        int indent_;
+
+        std::vector<Scope> scopes_;
+        bool first_{true};      // Nothing written yet in the innermost scope
+        bool after_key_{false}; // A key was written and its value is due
+        bool done_{false};      // The root value is complete
+        std::string error_;     // First output error; later output is dropped
+
+        void before_value();
+        void after_value();
+        void newline(size_t depth);
+        void write_string(std::string_view text);
+        void write_double(double number);
+        void write_integer(int64_t number);
+        void write_unsigned(uint64_t number);
+        void end_scope(Scope scope, char close);
+
+    public:
+        /// Append to `out`.
+        explicit Writer(std::string& out, SerializeOptions options = {});
+        /// Hand the output to `sink` in chunks.
+        explicit Writer(std::function<void(std::string_view)> sink, SerializeOptions options = {});
+        /// Write to the file descriptor `fd`, which stays open.
+        explicit Writer(int fd, SerializeOptions options = {});
+        explicit Writer(std::ostream& out, SerializeOptions options = {});
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        /// Flushes whatever is still buffered; call finish() to learn whether that worked.
+        ~Writer();
+
+        Writer& begin_object();
+        Writer& end_object();
+        Writer& begin_array();
+        Writer& end_array();
+        /// The key of the next object member.
+        Writer& key(std::string_view name);
+
+        Writer& value(std::string_view text);
+        Writer& value(const char* text);
+        Writer& value(double number);
+        Writer& value(bool boolean);
+        /// Integers are written exactly, including those a double cannot hold.
+        template <std::integral T>
+            requires(!std::same_as<T, bool>)
+        Writer& value(T number) {
+            before_value();
+            if constexpr (std::is_signed_v<T>) {
+                write_integer(static_cast<int64_t>(number));
+            }
+            else {
+                write_unsigned(static_cast<uint64_t>(number));
+            }
+            after_value();
+            return *this;
+        }
+        /// A whole tree, as serialize() would write it.
+        Writer& value(const Value& tree);
+        Writer& null();
+
+        /// Hand everything buffered to the sink.
+        void flush();
+        /// Flush, and report an output error or a document that is not yet one complete value.
+        std::expected<void, std::string> finish();
+
+        /// Whether one complete root value has been written.
+        [[nodiscard]] bool complete() const;
+    };
+} // namespace choochoo::json
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHOOCHOO_JSON_HAS_MMAP 1
+#endif
+#include "choochoo/document.hpp"
+#include "choochoo/lexer.hpp"
+#include "choochoo/parser.hpp"
+
+namespace choochoo::json {
+
+    static constexpr size_t INITIAL_ARENA_SIZE = 4096;
+    static constexpr size_t MAX_INITIAL_ARENA_SIZE = size_t{1} << 20;
+
+    static std::unexpected<Error> file_error(ErrorCode code, int system_error = 0) {
+        return std::unexpected(Error{.code = code, .system_error = system_error});
+    }
+
+    std::expected<std::shared_ptr<const MappedFile>, Error> MappedFile::open(const std::string& path) {
+        std::shared_ptr<MappedFile> file(new MappedFile());
+#ifdef CHOOCHOO_JSON_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return file_error(ErrorCode::FILE_OPEN_FAILED, errno);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            const int error = errno;
+            ::close(fd);
+            return file_error(ErrorCode::FILE_STAT_FAILED, error);
+        }
+        file->size_ = static_cast<size_t>(info.st_size);
+        if (file->size_ > 0) {
+            void* mapping = ::mmap(nullptr, file->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                const int error = errno;
+                ::close(fd);
+                return file_error(ErrorCode::FILE_MAP_FAILED, error);
+            }
+            // The lexer reads front to back once, so ask for aggressive read-ahead
+            ::madvise(mapping, file->size_, MADV_SEQUENTIAL);
+            ::madvise(mapping, file->size_, MADV_WILLNEED);
+            file->data_ = static_cast<const char*>(mapping);
+            file->mapped_ = true;
+        }
+        // The mapping stays valid after the descriptor is closed
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return file_error(ErrorCode::FILE_OPEN_FAILED);
+        }
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        file->buffer_ = std::move(contents).str();
+        file->data_ = file->buffer_.data();
+        file->size_ = file->buffer_.size();
+#endif
+        return file;
+    }
+
+    MappedFile::~MappedFile() {
+#ifdef CHOOCHOO_JSON_HAS_MMAP
+        if (mapped_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    const char* MappedFile::data() const { return data_ != nullptr ? data_ : ""; }
+
+    size_t MappedFile::size() const { return size_; }
+
+    std::string_view MappedFile::view() const { return {data(), size_}; }
+
+    Document::Document(Value root, std::shared_ptr<KeyTable> keys, std::shared_ptr<const MappedFile> file,
+                       std::unique_ptr<std::pmr::memory_resource> arena) :
+        file_(std::move(file)), keys_(std::move(keys)), arena_(std::move(arena)), root_(std::move(root)) {}
+
+    const Value& Document::root() const { return root_; }
+
+    Value& Document::root() { return root_; }
+
+    std::string_view Document::source() const { return file_ ? file_->view() : std::string_view(); }
+
+    std::expected<Document, Error> parse_file(const std::string& path) {
+        auto file = MappedFile::open(path);
+        if (!file)
+            return std::unexpected(file.error());
+
+        // A parsed tree takes roughly as many bytes as its source, so start the arena at that size, but no bigger than
+        // MAX_INITIAL_ARENA_SIZE: the arena grows its blocks geometrically, and reserving the size of a huge file up
+        // front would put on the heap what the mapping leaves to the page cache
+        auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(
+            std::clamp<size_t>(file.value()->size(), INITIAL_ARENA_SIZE, MAX_INITIAL_ARENA_SIZE));
+        Lexer lexer(file.value()->view());
+        // The Document keeps the mapping alive, so strings without escapes can stay in it
+        Parser parser(lexer, ParseOptions{.memory_resource = arena.get(), .zero_copy_strings = true});
+        auto result = parser.parse();
+        if (!result)
+            return std::unexpected(result.error());
+        return Document(std::move(result.value()), parser.key_table(), std::move(file.value()), std::move(arena));
+    }
+
+} // namespace choochoo::json
@@ -0,0 +1,56 @@
+#include "choochoo/document_stream.hpp"
+
+namespace choochoo::json {
+
+    DocumentStream::DocumentStream(std::string_view input, ParseOptions options) :
+        lexer_(input), parser_(lexer_, std::move(options)) {}
+
+    DocumentStream::DocumentStream(std::shared_ptr<const MappedFile> file, ParseOptions options) :
+        file_(std::move(file)), lexer_(file_->view()), parser_(lexer_, std::move(options)) {}
+
+    DocumentStream::DocumentStream(std::istream& input, ParseOptions options, size_t block_size) :
+        lexer_(input, block_size), parser_(lexer_, std::move(options)) {}
+
+    std::optional<StreamDocument> DocumentStream::next() {
+        if (parser_.at_end()) {
+            return std::nullopt;
+        }
+        const Token start = parser_.current_token();
+        auto value = parser_.parse_next();
+        if (value) {
+            return StreamDocument{std::move(value), start.offset, lexer_.previous_token_end()};
+        }
+
+        // The parser is left on the token where the error was found
+        if (value.error().line > start.line) {
+            return StreamDocument{std::move(value), start.offset, parser_.current_token().offset};
+        }
+        lexer_.skip_line();
+        parser_.reset();
+        return StreamDocument{std::move(value), start.offset, lexer_.previous_token_end()};
+    }
+
+    void DocumentStream::recycle(Value&& tree) { parser_.recycle(std::move(tree)); }
+
+    const std::shared_ptr<KeyTable>& DocumentStream::key_table() const { return parser_.key_table(); }
+
+    DocumentStream::iterator::iterator(DocumentStream* stream) : stream_(stream), current_(stream->next()) {}
+
+    StreamDocument& DocumentStream::iterator::operator*() { return *current_; }
+
+    StreamDocument* DocumentStream::iterator::operator->() { return &*current_; }
+
+    DocumentStream::iterator& DocumentStream::iterator::operator++() {
+        current_ = stream_->next();
+        return *this;
+    }
+
+    bool DocumentStream::iterator::operator==(const iterator& other) const {
+        return current_.has_value() == other.current_.has_value();
+    }
+
+    DocumentStream::iterator DocumentStream::begin() { return iterator(this); }
+
+    DocumentStream::iterator DocumentStream::end() { return iterator(); }
+
+} // namespace choochoo::json
@@ -0,0 +1,175 @@
+#include <system_error>
+#include "choochoo/error.hpp"
+
+namespace choochoo::json {
+
+    const char* token_type_name(token::Type type) {
+        switch (type) {
+        case token::Type::STRING:
+            return "STRING";
+        case token::Type::NUMBER:
+            return "NUMBER";
+        case token::Type::TRUE:
+            return "TRUE";
+        case token::Type::FALSE:
+            return "FALSE";
+        case token::Type::NULL_VALUE:
+            return "NULL";
+        case token::Type::LBRACE:
+            return "LBRACE";
+        case token::Type::RBRACE:
+            return "RBRACE";
+        case token::Type::LBRACKET:
+            return "LBRACKET";
+        case token::Type::RBRACKET:
+            return "RBRACKET";
+        case token::Type::COMMA:
+            return "COMMA";
+        case token::Type::COLON:
+            return "COLON";
+        case token::Type::EOF_TOKEN:
+            return "EOF";
+        case token::Type::INVALID:
+            return "INVALID";
+        default:
+            return "UNKNOWN";
+        }
+    }
+
+    std::string Error::message() const {
+        std::string text;
+        bool names_token = false; // Whether the message goes on to say which token was found instead
+        bool in_path = false;     // Whether offset is a position in a path rather than in a document
+        switch (code) {
+        case ErrorCode::UNEXPECTED_EOF:
+            text = "No value to parse (unexpected EOF)";
+            break;
+        case ErrorCode::UNEXPECTED_TOKEN:
+            text = std::string("Unexpected token ") + token_type_name(token);
+            break;
+        case ErrorCode::UNEXPECTED_CHARACTER:
+            text = "Unexpected character";
+            break;
+        case ErrorCode::UNTERMINATED_STRING:
+            text = "Unterminated string";
+            break;
+        case ErrorCode::CONTROL_CHARACTER:
+            text = "Unescaped control character in string";
+            break;
+        case ErrorCode::INVALID_LITERAL:
+            text = "Invalid literal";
+            break;
+        case ErrorCode::INVALID_NUMBER:
+            text = "Invalid number format";
+            break;
+        case ErrorCode::INVALID_ESCAPE:
+            text = "Invalid escape sequence";
+            break;
+        case ErrorCode::INVALID_UNICODE_ESCAPE:
+            text = "Invalid unicode escape";
+            break;
+        case ErrorCode::EXPECTED_KEY:
+            text = "Expected string key in object";
+            names_token = true;
+            break;
+        case ErrorCode::EXPECTED_COLON:
+            text = "Expected ':' after object key";
+            names_token = true;
+            break;
+        case ErrorCode::EXPECTED_OBJECT_END:
+            text = "Expected ',' or '}' in object";
+            names_token = true;
+            break;
+        case ErrorCode::EXPECTED_ARRAY_END:
+            text = "Expected ',' or ']' in array";
+            names_token = true;
+            break;
+        case ErrorCode::DEPTH_EXCEEDED:
+            text = "Maximum nesting depth exceeded";
+            break;
+        case ErrorCode::TRAILING_CONTENT:
+            text = "Unexpected content after JSON value";
+            break;
+        case ErrorCode::INPUT_TOO_LARGE:
+            text = "Input too large for a structural index";
+            break;
+        case ErrorCode::EXPECTED_VALUE:
+            text = "Expected a value";
+            break;
+        case ErrorCode::EXPECTED_OBJECT:
+            text = "Expected an object";
+            break;
+        case ErrorCode::EXPECTED_ARRAY:
+            text = "Expected an array";
+            break;
+        case ErrorCode::EXPECTED_STRING:
+            text = "Expected a string";
+            break;
+        case ErrorCode::EXPECTED_NUMBER:
+            text = "Expected a number";
+            break;
+        case ErrorCode::EXPECTED_INT64:
+            text = "Expected a 64-bit integer";
+            break;
+        case ErrorCode::EXPECTED_BOOLEAN:
+            text = "Expected a boolean";
+            break;
+        case ErrorCode::MALFORMED_VALUE:
+            text = "Unterminated or unbalanced value";
+            break;
+        case ErrorCode::NO_SUCH_FIELD:
+            text = "No such field in object";
+            break;
+        case ErrorCode::INDEX_OUT_OF_RANGE:
+            text = "Array index out of range";
+            break;
+        case ErrorCode::POINTER_WITHOUT_SLASH:
+            return "JSON Pointer must be empty or start with '/'.";
+        case ErrorCode::INVALID_POINTER_ESCAPE:
+            text = "Invalid escape in JSON Pointer, expected ~0 or ~1";
+            in_path = true;
+            break;
+        case ErrorCode::EMPTY_PATH_NAME:
+            text = "Empty member name in path";
+            in_path = true;
+            break;
+        case ErrorCode::UNTERMINATED_PATH_INDEX:
+            text = "Unterminated '[' in path";
+            in_path = true;
+            break;
+        case ErrorCode::INVALID_PATH_INDEX:
+            text = "Invalid array index in path";
+            in_path = true;
+            break;
+        case ErrorCode::EXPECTED_PATH_SEPARATOR:
+            text = "Expected '.' or '[' in path";
+            in_path = true;
+            break;
+        case ErrorCode::FILE_OPEN_FAILED:
+            text = "Cannot open file";
+            break;
+        case ErrorCode::FILE_STAT_FAILED:
+            text = "Cannot stat file";
+            break;
+        case ErrorCode::FILE_MAP_FAILED:
+            text = "Cannot map file";
+            break;
+        }
+        if (names_token) {
+            text += ", but found ";
+            text += token_type_name(token);
+        }
+        if (system_error != 0) {
+            text += ": " + std::generic_category().message(system_error);
+        }
+        if (in_path) {
+            text += " at position " + std::to_string(offset);
+        }
+        else if (line != 0) {
+            text += " at line " + std::to_string(line) + ", column " + std::to_string(column);
+        }
+        text += '.';
+        return text;
+    }
+
+} // namespace choochoo::json
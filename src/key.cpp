@@ -0,0 +1,104 @@
+#include <limits>
+#include "choochoo/key.hpp"
+
+namespace choochoo::json {
+
+    Key::Key(std::string_view text, KeyTable* table) : std::string(text), hash_(hash_of(text)), table_(table) {}
+
+    size_t Key::hash_of(std::string_view text) { return std::hash<std::string_view>{}(text); }
+
+    // Shards are picked by the top bits of the hash and slots by the bottom bits, so the two stay independent
+    KeyTable::Shard& KeyTable::shard_for(size_t hash) {
+        return shards_[hash >> (std::numeric_limits<size_t>::digits - SHARD_BITS)];
+    }
+
+    const KeyTable::Shard& KeyTable::shard_for(size_t hash) const {
+        return shards_[hash >> (std::numeric_limits<size_t>::digits - SHARD_BITS)];
+    }
+
+    const Key* KeyTable::probe(const Slots& slots, std::string_view text, size_t hash) {
+        for (size_t i = hash & slots.mask;; i = (i + 1) & slots.mask) {
+            const Key* key = slots.slots[i].load(std::memory_order_acquire);
+            if (key == nullptr) {
+                return nullptr;
+            }
+            if (key->hash() == hash && *key == text) {
+                return key;
+            }
+        }
+    }
+
+    void KeyTable::place(const Slots& slots, const Key* key) {
+        size_t i = key->hash() & slots.mask;
+        while (slots.slots[i].load(std::memory_order_relaxed) != nullptr) {
+            i = (i + 1) & slots.mask;
+        }
+        // Release, so a reader that finds the pointer also sees the key it points to
+        slots.slots[i].store(key, std::memory_order_release);
+    }
+
+    // Shards allocate their slots on first use, so a table that only ever sees a few keys stays cheap to create
+    KeyTable::KeyTable() = default;
+
+    KeyTable::~KeyTable() = default;
+
+    const std::shared_ptr<KeyTable>& KeyTable::global() {
+        // Leaked on purpose: keys stay valid for objects destroyed during static destruction. The pointer owns
+        // nothing, so the objects holding on to it never touch a shared reference count.
+        static const auto* table = new std::shared_ptr<KeyTable>(std::shared_ptr<KeyTable>(), new KeyTable());
+        return *table;
+    }
+
+    std::shared_ptr<KeyTable> KeyTable::retain() {
+        if (auto owned = weak_from_this().lock()) {
+            return owned;
+        }
+        return std::shared_ptr<KeyTable>(std::shared_ptr<KeyTable>(), this);
+    }
+
+    const Key* KeyTable::find(std::string_view text) const {
+        const size_t hash = Key::hash_of(text);
+        const Slots* slots = shard_for(hash).current.load(std::memory_order_acquire);
+        return slots != nullptr ? probe(*slots, text, hash) : nullptr;
+    }
+
+    const Key* KeyTable::intern(std::string_view text) {
+        const size_t hash = Key::hash_of(text);
+        Shard& shard = shard_for(hash);
+        if (const Slots* slots = shard.current.load(std::memory_order_acquire)) {
+            if (const Key* key = probe(*slots, text, hash)) {
+                return key;
+            }
+        }
+
+        std::lock_guard lock(shard.mutex);
+        // Another thread may have inserted it while we waited for the lock
+        const Slots* slots = shard.current.load(std::memory_order_relaxed);
+        if (slots != nullptr) {
+            if (const Key* key = probe(*slots, text, hash)) {
+                return key;
+            }
+        }
+        const Key* key = shard.keys.emplace_back(std::make_unique<Key>(text, this)).get();
+        size_.fetch_add(1, std::memory_order_relaxed);
+
+        // Keep shards at most half full so probe sequences stay short
+        if (slots == nullptr || shard.keys.size() * 2 > slots->mask + 1) {
+            const size_t capacity = slots == nullptr ? INITIAL_SLOTS : (slots->mask + 1) * 2;
+            auto grown =
+                std::make_unique<Slots>(Slots{capacity - 1, std::make_unique<std::atomic<const Key*>[]>(capacity)});
+            for (const auto& existing : shard.keys) {
+                place(*grown, existing.get());
+            }
+            shard.current.store(grown.get(), std::memory_order_release);
+            shard.generations.push_back(std::move(grown));
+        }
+        else {
+            place(*slots, key);
+        }
+        return key;
+    }
+
+    size_t KeyTable::size() const { return size_.load(std::memory_order_relaxed); }
+
+} // namespace choochoo::json
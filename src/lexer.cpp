@@ -1,252 +1,148 @@
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include "choochoo/lexer.hpp"
+#include "choochoo/simd.hpp"
 
 namespace choochoo::json {
 
-    char Lexer::current_char() const {
-        if (using_stream_) {
-            // Refill buffer if empty
-            if (stream_count_ == 0 && input_stream_ && input_stream_->good()) {
-                int next = input_stream_->get();
-                if (next != std::char_traits<char>::eof()) {
-                    const_cast<char&>(stream_buffer_[stream_tail_]) = static_cast<char>(next);
-                    const_cast<size_t&>(stream_tail_) = (stream_tail_ + 1) % STREAM_BUFFER_SIZE;
-                    const_cast<size_t&>(stream_count_)++;
-                }
-            }
-            if (stream_count_ == 0) {
-                return '\0';
-            }
-            return stream_buffer_[stream_head_];
+    // JSON whitespace only; std::isspace is locale-dependent and also accepts \v and \f
+    static bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    char Lexer::current_char() {
+        if (position_ < input_.size() || (using_stream_ && refill())) {
+            return input_[position_];
         }
-        return position_ < input_.size() ? input_[position_] : '\0';
+        return '\0';
     }
 
     char Lexer::peek_char(size_t offset) {
-        if (using_stream_) {
-            // Fill buffer if needed
-            while (stream_count_ <= offset && input_stream_ && input_stream_->good() &&
-                   stream_count_ < STREAM_BUFFER_SIZE) {
-                int next = input_stream_->get();
-                if (next == std::char_traits<char>::eof())
-                    break;
-                stream_buffer_[stream_tail_] = static_cast<char>(next);
-                stream_tail_ = (stream_tail_ + 1) % STREAM_BUFFER_SIZE;
-                stream_count_++;
-            }
-            if (stream_count_ > offset) {
-                size_t idx = (stream_head_ + offset) % STREAM_BUFFER_SIZE;
-                return stream_buffer_[idx];
+        while (position_ + offset >= input_.size()) {
+            if (!using_stream_ || !refill()) {
+                return '\0';
             }
-            return '\0';
         }
-        size_t peek_pos = position_ + offset;
-        return peek_pos < input_.size() ? input_[peek_pos] : '\0';
+        return input_[position_ + offset];
     }
 
     void Lexer::advance() {
-        if (using_stream_) {
-            if (stream_count_ > 0) {
-                char ch = stream_buffer_[stream_head_];
-                stream_head_ = (stream_head_ + 1) % STREAM_BUFFER_SIZE;
-                stream_count_--;
-                if (ch == '\n') {
-                    stream_line_++;
-                    stream_column_ = 1;
-                }
-                else {
-                    stream_column_++;
-                }
+        if (position_ < input_.size()) {
+            if (input_[position_] == '\n') {
+                line_++;
+                column_ = 1;
             }
-            // Always refill buffer after popping if empty
-            while (stream_count_ < 1 && input_stream_ && input_stream_->good()) {
-                int next = input_stream_->get();
-                if (next == std::char_traits<char>::eof())
-                    break;
-                stream_buffer_[stream_tail_] = static_cast<char>(next);
-                stream_tail_ = (stream_tail_ + 1) % STREAM_BUFFER_SIZE;
-                stream_count_++;
+            else {
+                column_++;
             }
+            position_++;
         }
-        else {
-            if (position_ < input_.size()) {
-                if (input_[position_] == '\n') {
-                    line_++;
-                    column_ = 1;
-                }
-                else {
-                    column_++;
-                }
-                position_++;
-            }
+    }
+
+    bool Lexer::refill() {
+        if (input_stream_ == nullptr || !input_stream_->good()) {
+            return false;
+        }
+        // Everything before the token being scanned is consumed; slide the rest to the front of the buffer
+        const size_t keep_from = retain_buffer_ ? 0 : std::min(token_start_, position_);
+        const size_t kept = input_.size() - keep_from;
+        if (keep_from > 0 && kept > 0) {
+            std::memmove(stream_buffer_.data(), stream_buffer_.data() + keep_from, kept);
         }
+        stream_offset_ += keep_from;
+        position_ -= keep_from;
+        token_start_ -= keep_from;
+
+        // Only a token longer than a whole block makes the buffer grow
+        if (stream_buffer_.size() < kept + stream_block_size_) {
+            stream_buffer_.resize(kept + stream_block_size_);
+        }
+        input_stream_->read(stream_buffer_.data() + kept, static_cast<std::streamsize>(stream_block_size_));
+        const auto read = static_cast<size_t>(input_stream_->gcount());
+        input_ = std::string_view(stream_buffer_.data(), kept + read);
+        return read > 0;
     }
 
     void Lexer::skip_whitespace() {
-        while (std::isspace(current_char())) {
-            advance();
+        while (true) {
+            // Most tokens are followed by at most one space, so check the first byte before calling the kernel
+            if (position_ < input_.size() && !is_whitespace(input_[position_])) {
+                break;
+            }
+            const char* begin = input_.data() + position_;
+            size_t newlines = 0;
+            const char* line_start = nullptr;
+            const char* stop = simd::skip_whitespace(begin, input_.data() + input_.size(), newlines, line_start);
+            position_ += stop - begin;
+            if (newlines > 0) {
+                line_ += newlines;
+                column_ = stop - line_start + 1;
+            }
+            else {
+                column_ += stop - begin;
+            }
+            token_start_ = position_;
+            // A run reaching the end of a stream block continues in the next one
+            if (position_ < input_.size() || !using_stream_ || !refill()) {
+                break;
+            }
         }
     }
 
     Token Lexer::make_token(token::Type type, size_t start_pos, size_t length) const {
-        if (using_stream_) {
-            // For streaming, we can't provide a string_view into the stream,
-            // so we'll use a placeholder for now.
-            // NOTE: We may want to buffer the token value in a later rev of the implementation
-            return Token{type, std::string(""), stream_line_, stream_column_ - length};
-        }
-        return Token{type, std::string_view(input_.data() + start_pos, length), line_, column_ - length};
+        return Token{type, std::string_view(input_.data() + start_pos, length), line_, column_ - length,
+                     stream_offset_ + start_pos};
     }
 
     Token Lexer::scan_string() {
-        if (using_stream_) {
-            size_t start_line = stream_line_;
-            size_t start_column = stream_column_;
-            advance(); // skip opening quote
-
-            std::string value;
-            bool escape = false;
-            // std::cout << "[scan_string] buffer before: ";
-            // for (char c : stream_buffer_)
-            //     std::cout << "'" << c << "' ";
-            // std::cout << std::endl;
-
-            while (true) {
-                char ch = current_char();
-                if (ch == '\0') {
-                    // Unterminated string
-
-                    return Token{token::Type::INVALID, value, stream_line_, stream_column_};
-                }
-                if (escape) {
-                    switch (ch) {
-                    case '"':
-                        value += '"';
-                        break;
-                    case '\\':
-                        value += '\\';
-                        break;
-                    case '/':
-                        value += '/';
-                        break;
-                    case 'b':
-                        value += '\b';
-                        break;
-                    case 'f':
-                        value += '\f';
-                        break;
-                    case 'n':
-                        value += '\n';
-                        break;
-                    case 'r':
-                        value += '\r';
-                        break;
-                    case 't':
-                        value += '\t';
-                        break;
-                    default:
-                        value += ch;
-                        break; // fallback: add raw char
-                    }
-                    escape = false;
-                }
-                else if (ch == '\\') {
-                    escape = true;
-                }
-                else if (ch == '"') {
-                    // End of string
-                    break;
-                }
-                else {
-                    value += ch;
-                }
-                advance();
-            }
-            advance(); // skip closing quote
-
-            // std::cout << "[scan_string] value='" << value << "'" << std::endl;
-            // std::cout << "[scan_string] buffer after: ";
-            // for (char c : stream_buffer_)
-            //     std::cout << "'" << c << "' ";
-            // std::cout << std::endl;
-
-            return Token{token::Type::STRING, value, start_line, start_column};
-        }
-        // Original string version
-        const size_t quote_pos = position_;
+        // Positions are taken relative to token_start_, which a stream refill keeps up to date
         const size_t start_column = column_;
+        bool has_escapes = false;
 
         advance();
-        const size_t start_pos = position_;
 
-        while (current_char() != '"' && current_char() != '\0') {
-            if (current_char() == '\\') {
+        while (true) {
+            // Jump over plain string bytes in bulk. They contain no newlines, so only the column moves.
+            const char* run = input_.data() + position_;
+            const size_t run_length = simd::find_string_special(run, input_.data() + input_.size()) - run;
+            position_ += run_length;
+            column_ += run_length;
+
+            const char ch = current_char();
+            if (ch == '"' || ch == '\0') {
+                break;
+            }
+            if (ch == '\\') {
+                has_escapes = true;
                 advance();
                 if (current_char() == '\0') {
                     break;
                 }
-                advance();
             }
-            else {
-                advance();
+            // A raw newline ends the string here rather than swallowing the lines after it
+            if (static_cast<unsigned char>(current_char()) < 0x20) {
+                invalid_reason_ = ErrorCode::CONTROL_CHARACTER;
+                return Token{token::Type::INVALID, input_.substr(token_start_, position_ - token_start_), line_,
+                             start_column, stream_offset_ + token_start_};
             }
+            advance(); // The escaped character
         }
 
         if (current_char() != '"') {
-            return Token{token::Type::INVALID, std::string(input_.substr(quote_pos)), line_, start_column + 1};
+            invalid_reason_ = ErrorCode::UNTERMINATED_STRING;
+            return Token{token::Type::INVALID, input_.substr(token_start_), line_, start_column,
+                         stream_offset_ + token_start_};
         }
 
+        const size_t start_pos = token_start_ + 1;
         size_t length = position_ - start_pos;
         std::string_view str_value = std::string_view(input_.data() + start_pos, length);
 
         advance();
 
-        return Token{token::Type::STRING, str_value, line_, start_column};
+        return Token{token::Type::STRING, str_value, line_, start_column, stream_offset_ + token_start_, has_escapes};
     }
 
     Token Lexer::scan_number() {
-        if (using_stream_) {
-            // Capture starting position BEFORE reading the number
-            size_t start_line = stream_line_;
-            size_t start_column = stream_column_;
-            std::string value;
-
-            // std::cout << "[scan_number] buffer before: ";
-            // for (char c : stream_buffer_)
-            //     std::cout << "'" << c << "' ";
-            // std::cout << std::endl;
-
-            auto is_number_char = [](char c) {
-                return std::isdigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
-            };
-
-            // Only consume number characters
-            while (is_number_char(current_char())) {
-                value += current_char();
-                advance();
-            }
-
-            // std::cout << "[scan_number] value='" << value << "'" << std::endl;
-            // std::cout << "[scan_number] buffer after: ";
-            // for (char c : stream_buffer_)
-            //     std::cout << "'" << c << "' ";
-            // std::cout << std::endl;
-
-            // Validate the number format
-            try {
-                std::stod(value);
-            }
-            catch (...) {
-                // TODO: improve debug output and error handling
-                return Token{token::Type::INVALID, value, start_line, start_column};
-            }
-
-            // Return the token with the correct value and starting position
-            return Token{token::Type::NUMBER, value, start_line, start_column};
-        }
-        // Original string version
-        const size_t start_pos = position_;
         const size_t start_column = column_;
 
         if (current_char() == '-') {
@@ -262,13 +158,17 @@ namespace choochoo::json {
             }
         }
         else {
-            return Token{token::Type::INVALID, std::string(input_.substr(start_pos)), line_, start_column};
+            invalid_reason_ = ErrorCode::INVALID_NUMBER;
+            return Token{token::Type::INVALID, input_.substr(token_start_), line_, start_column,
+                         stream_offset_ + token_start_};
         }
 
         if (current_char() == '.') {
             advance();
             if (!std::isdigit(current_char())) {
-                return Token{token::Type::INVALID, std::string(input_.substr(start_pos)), line_, start_column};
+                invalid_reason_ = ErrorCode::INVALID_NUMBER;
+                return Token{token::Type::INVALID, input_.substr(token_start_), line_, start_column,
+                             stream_offset_ + token_start_};
             }
             while (std::isdigit(current_char())) {
                 advance();
@@ -281,51 +181,29 @@ namespace choochoo::json {
                 advance();
             }
             if (!std::isdigit(current_char())) {
-                return Token{token::Type::INVALID, std::string(input_.substr(start_pos)), line_, start_column};
+                invalid_reason_ = ErrorCode::INVALID_NUMBER;
+                return Token{token::Type::INVALID, input_.substr(token_start_), line_, start_column,
+                             stream_offset_ + token_start_};
             }
             while (std::isdigit(current_char())) {
                 advance();
             }
         }
 
-        size_t length = position_ - start_pos;
-        return Token{token::Type::NUMBER, std::string_view(input_.data() + start_pos, length), line_, start_column};
+        size_t length = position_ - token_start_;
+        return Token{token::Type::NUMBER, std::string_view(input_.data() + token_start_, length), line_,
+                     start_column, stream_offset_ + token_start_};
     }
 
     Token Lexer::scan_keyword() {
-        if (using_stream_) {
-            size_t start_line = stream_line_;
-            size_t start_column = stream_column_;
-            std::string word;
-            while (std::isalpha(current_char())) {
-                word += current_char();
-                advance();
-            }
-            token::Type type;
-            if (word == "true") {
-                type = token::Type::TRUE;
-            }
-            else if (word == "false") {
-                type = token::Type::FALSE;
-            }
-            else if (word == "null") {
-                type = token::Type::NULL_VALUE;
-            }
-            else {
-                type = token::Type::INVALID;
-            }
-            return Token{type, word, start_line, start_column};
-        }
-        // Original string version
-        const size_t start_pos = position_;
         const size_t start_column = column_;
 
         while (std::isalpha(current_char())) {
             advance();
         }
 
-        size_t length = position_ - start_pos;
-        std::string_view word = std::string_view(input_.data() + start_pos, length);
+        size_t length = position_ - token_start_;
+        std::string_view word = std::string_view(input_.data() + token_start_, length);
 
         token::Type type;
         if (word == "true") {
@@ -339,116 +217,72 @@ namespace choochoo::json {
         }
         else {
             type = token::Type::INVALID;
+            invalid_reason_ = ErrorCode::INVALID_LITERAL;
         }
-        return Token{type, word, line_, start_column};
+        return Token{type, word, line_, start_column, stream_offset_ + token_start_};
     }
 
     Lexer::Lexer(std::string_view input) : input_(input), position_(0), line_(1), column_(1), using_stream_(false) {}
 
-    Lexer::Lexer(std::istream& input) : input_stream_(&input), using_stream_(true), stream_line_(1), stream_column_(1) {
-        // Fill buffer with first character for lookahead
-        if (input_stream_ && input_stream_->good()) {
-            int next = input_stream_->get();
-            if (next != std::char_traits<char>::eof()) {
-                stream_buffer_[stream_tail_] = static_cast<char>(next);
-                stream_tail_ = (stream_tail_ + 1) % STREAM_BUFFER_SIZE;
-                stream_count_++;
-            }
-        }
+    Lexer::Lexer(std::istream& input, size_t block_size) :
+        position_(0), line_(1), column_(1), input_stream_(&input), stream_block_size_(std::max<size_t>(block_size, 1)),
+        using_stream_(true) {
+        stream_buffer_.resize(stream_block_size_);
+        input_ = std::string_view(stream_buffer_.data(), 0);
+    }
+
+    void Lexer::reset(std::string_view input) {
+        input_ = input;
+        position_ = 0;
+        line_ = 1;
+        column_ = 1;
+        input_stream_ = nullptr;
+        stream_offset_ = 0;
+        token_start_ = 0;
+        previous_end_ = 0;
+        retain_buffer_ = false;
+        using_stream_ = false;
+        invalid_reason_ = ErrorCode::UNEXPECTED_CHARACTER;
     }
 
     Token Lexer::next_token() {
+        token_start_ = position_;
+        previous_end_ = stream_offset_ + position_;
         skip_whitespace();
 
-        if (using_stream_) {
-            if (current_char() == '\0') {
-                // std::cout << "[next_token] EOF at line " << stream_line_ << ", column " << stream_column_ <<
-                // std::endl; std::cout << "[next_token] Buffer: "; for (char c : stream_buffer_)
-                //     std::cout << "'" << c << "' ";
-                // std::cout << std::endl;
-                return Token{token::Type::EOF_TOKEN, std::string(""), stream_line_, stream_column_};
-            }
-        }
-        else {
-            if (position_ >= input_.size()) {
-                return Token{token::Type::EOF_TOKEN, std::string_view(""), line_, column_};
-            }
+        if (position_ >= input_.size()) {
+            return Token{token::Type::EOF_TOKEN, {}, line_, column_, stream_offset_ + position_};
         }
 
         char ch = current_char();
-        size_t current_column = using_stream_ ? stream_column_ : column_;
-
-        if (using_stream_) {
-            // std::cout << "[next_token] Processing char '" << ch << "' (int: " << int(ch) << ") at line " <<
-            // stream_line_
-            //           << ", column " << stream_column_ << std::endl;
-            // std::cout << "[next_token] Buffer: ";
-            // for (char c : stream_buffer_)
-            //     std::cout << "'" << c << "' ";
-            // std::cout << std::endl;
-        }
+        size_t current_column = column_;
+        const size_t offset = stream_offset_ + position_;
 
         Token token;
         switch (ch) {
         case '{':
             advance();
-            if (using_stream_) {
-                token = Token{token::Type::LBRACE, std::string("{"), stream_line_, current_column};
-            }
-            else {
-                token = Token{token::Type::LBRACE, std::string_view(input_.data() + position_ - 1, 1), line_,
-                              current_column};
-            }
+            token = Token{token::Type::LBRACE, {}, line_, current_column, offset};
             break;
         case '}':
             advance();
-            if (using_stream_) {
-                token = Token{token::Type::RBRACE, std::string("}"), stream_line_, current_column};
-            }
-            else {
-                token = Token{token::Type::RBRACE, std::string_view(input_.data() + position_ - 1, 1), line_,
-                              current_column};
-            }
+            token = Token{token::Type::RBRACE, {}, line_, current_column, offset};
             break;
         case '[':
             advance();
-            if (using_stream_) {
-                token = Token{token::Type::LBRACKET, std::string("["), stream_line_, current_column};
-            }
-            else {
-                token = Token{token::Type::LBRACKET, std::string_view(input_.data() + position_ - 1, 1), line_,
-                              current_column};
-            }
+            token = Token{token::Type::LBRACKET, {}, line_, current_column, offset};
             break;
         case ']':
             advance();
-            if (using_stream_) {
-                token = Token{token::Type::RBRACKET, std::string("]"), stream_line_, current_column};
-            }
-            else {
-                token = Token{token::Type::RBRACKET, std::string_view(input_.data() + position_ - 1, 1), line_,
-                              current_column};
-            }
+            token = Token{token::Type::RBRACKET, {}, line_, current_column, offset};
             break;
         case ',':
             advance();
-            if (using_stream_) {
-                token = Token{token::Type::COMMA, std::string(","), stream_line_, current_column};
-            }
-            else {
-                token = Token{token::Type::COMMA, std::string_view(input_.data() + position_ - 1, 1), line_,
-                              current_column};
-            }
+            token = Token{token::Type::COMMA, {}, line_, current_column, offset};
             break;
         case ':':
             advance();
-            if (using_stream_) {
-                token = Token{token::Type::COLON, std::string(":"), stream_line_, current_column};
-            }
-            else {
-                token = Token{token::Type::COLON, std::string_view(input_.data() + position_ - 1, 1), line_,
-                              current_column};
-            }
+            token = Token{token::Type::COLON, {}, line_, current_column, offset};
             break;
         case '"':
             token = scan_string();
@@ -472,24 +306,12 @@ namespace choochoo::json {
             }
             else {
                 advance();
-                if (using_stream_) {
-                    token = Token{token::Type::INVALID, std::string(1, ch), stream_line_, current_column};
-                }
-                else {
-                    token = Token{token::Type::INVALID, std::string_view(input_.data() + position_ - 1, 1), line_,
-                                  current_column};
-                }
+                invalid_reason_ = ErrorCode::UNEXPECTED_CHARACTER;
+                token = Token{token::Type::INVALID, std::string_view(input_.data() + position_ - 1, 1), line_,
+                              current_column, offset};
             }
             break;
         }
-        if (using_stream_) {
-            // std::cout << "[next_token] Returned token: type=" << static_cast<int>(token.type_) << ", value='"
-            //           << token.value << "', line=" << token.line << ", column=" << token.column << std::endl;
-            // std::cout << "[next_token] Buffer after token: ";
-            // for (char c : stream_buffer_)
-            //     std::cout << "'" << c << "' ";
-            // std::cout << std::endl;
-        }
         return token;
     }
 
@@ -497,13 +319,135 @@ namespace choochoo::json {
         std::vector<Token> tokens;
         Token token;
 
+        // Every returned token views the buffer, so stream input must not be compacted underneath them. The buffer
+        // may still move when it grows, so remember where each payload starts and re-point the views at the end.
+        std::vector<size_t> starts;
+        retain_buffer_ = using_stream_;
         do {
             token = next_token();
             tokens.push_back(token);
+            if (using_stream_) {
+                starts.push_back(token.value.empty() ? 0 : token.value.data() - input_.data());
+            }
         }
         while (token.type_ != token::Type::EOF_TOKEN && token.type_ != token::Type::INVALID);
+        retain_buffer_ = false;
+
+        for (size_t i = 0; i < starts.size(); ++i) {
+            tokens[i].value = input_.substr(starts[i], tokens[i].value.size());
+        }
 
         return tokens;
     }
 
+    Token Lexer::index_token(size_t offset, size_t end, bool has_escapes) {
+        if (offset >= input_.size()) {
+            position_ = input_.size();
+            return Token{token::Type::EOF_TOKEN, {}, 0, 0, input_.size()};
+        }
+        end = std::min(end, input_.size());
+
+        token::Type type;
+        switch (input_[offset]) {
+        case '{':
+            type = token::Type::LBRACE;
+            break;
+        case '}':
+            type = token::Type::RBRACE;
+            break;
+        case '[':
+            type = token::Type::LBRACKET;
+            break;
+        case ']':
+            type = token::Type::RBRACKET;
+            break;
+        case ',':
+            type = token::Type::COMMA;
+            break;
+        case ':':
+            type = token::Type::COLON;
+            break;
+        case '"': {
+            // The index guarantees `end` is the matching closing quote, unless a raw control character comes first
+            if (end == input_.size() || input_[end] != '"') {
+                position_ = end;
+                invalid_reason_ = ErrorCode::CONTROL_CHARACTER;
+                return Token{token::Type::INVALID, std::string_view(input_.data() + offset, end - offset), 0, 0,
+                             offset};
+            }
+            position_ = end + 1;
+            const std::string_view str_value(input_.data() + offset + 1, end - offset - 1);
+            return Token{token::Type::STRING, str_value, 0, 0, offset, has_escapes};
+        }
+        default: {
+            position_ = offset;
+            token_start_ = offset;
+            const char ch = input_[offset];
+            Token token;
+            if (ch == '-' || std::isdigit(static_cast<unsigned char>(ch))) {
+                token = scan_number();
+            }
+            else if (std::isalpha(static_cast<unsigned char>(ch))) {
+                token = scan_keyword();
+            }
+            else {
+                invalid_reason_ = ErrorCode::UNEXPECTED_CHARACTER;
+                token = Token{token::Type::INVALID, std::string_view(input_.data() + offset, 1), 0, 0, offset};
+            }
+            // A scalar must run right up to the next structural character, e.g. reject `12abc`
+            while (position_ < end && is_whitespace(input_[position_])) {
+                ++position_;
+            }
+            if (token.type_ != token::Type::INVALID && position_ != end) {
+                invalid_reason_ = token.type_ == token::Type::NUMBER ? ErrorCode::INVALID_NUMBER
+                                                                     : ErrorCode::INVALID_LITERAL;
+                token = Token{token::Type::INVALID, std::string_view(input_.data() + offset, end - offset), 0, 0,
+                              offset};
+            }
+            token.line = 0;
+            token.column = 0;
+            return token;
+        }
+        }
+        position_ = offset + 1;
+        return Token{type, {}, 0, 0, offset};
+    }
+
+    size_t Lexer::previous_token_end() const { return previous_end_; }
+
+    void Lexer::skip_line() {
+        while (true) {
+            const size_t newline = input_.find('\n', position_);
+            if (newline != std::string_view::npos) {
+                position_ = newline + 1;
+                ++line_;
+                column_ = 1;
+                return;
+            }
+            column_ += input_.size() - position_;
+            position_ = input_.size();
+            token_start_ = position_; // Let refill() drop the skipped bytes
+            if (!using_stream_ || !refill()) {
+                return;
+            }
+        }
+    }
+
+    ErrorCode Lexer::invalid_reason() const { return invalid_reason_; }
+
+    std::pair<size_t, size_t> Lexer::locate(size_t offset) const {
+        const size_t end = std::min(offset, input_.size());
+        size_t line = 1;
+        size_t line_start = 0;
+        for (size_t i = 0; i < end; ++i) {
+            if (input_[i] == '\n') {
+                ++line;
+                line_start = i + 1;
+            }
+        }
+        return {line, end - line_start + 1};
+    }
+
+    bool Lexer::is_streaming() const { return using_stream_; }
+
 } // namespace choochoo::json
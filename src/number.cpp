@@ -0,0 +1,149 @@
+#include <charconv>
+#include <system_error>
+#include "choochoo/number.hpp"
+
+namespace choochoo::json::number {
+
+    namespace {
+        // Every power of ten up to 1e22 is exactly representable as a double
+        constexpr double EXACT_POWERS_OF_TEN[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        constexpr uint64_t MAX_EXACT_MANTISSA = uint64_t{1} << 53;
+        constexpr int MAX_MANTISSA_DIGITS = 19;
+
+        bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    } // namespace
+
+    std::optional<double> parse_double(std::string_view text) {
+        const char* p = text.data();
+        const char* const end = p + text.size();
+
+        const bool negative = p != end && *p == '-';
+        if (negative) {
+            ++p;
+        }
+
+        // Integer and fraction digits are gathered into one decimal mantissa
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+
+        if (p == end) {
+            return std::nullopt;
+        }
+        if (*p == '0') {
+            ++p;
+        }
+        else if (is_digit(*p)) {
+            for (; p != end && is_digit(*p); ++p) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                ++digits;
+            }
+        }
+        else {
+            return std::nullopt;
+        }
+
+        if (p != end && *p == '.') {
+            ++p;
+            if (p == end || !is_digit(*p)) {
+                return std::nullopt;
+            }
+            for (; p != end && is_digit(*p); ++p) {
+                // Leading zeros of a fraction like 0.000123 add no significant digits
+                if (mantissa != 0 || *p != '0') {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    ++digits;
+                }
+                --exponent;
+            }
+        }
+
+        if (p != end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            const bool negative_exponent = p != end && *p == '-';
+            if (p != end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (p == end || !is_digit(*p)) {
+                return std::nullopt;
+            }
+            int explicit_exponent = 0;
+            for (; p != end && is_digit(*p); ++p) {
+                // Saturate; anything this large is out of range or zero regardless
+                if (explicit_exponent < 100000) {
+                    explicit_exponent = explicit_exponent * 10 + (*p - '0');
+                }
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+        }
+
+        if (p != end) {
+            return std::nullopt;
+        }
+
+        // Clinger's fast path: an exact mantissa scaled by an exact power of ten rounds correctly in one operation
+        if (digits <= MAX_MANTISSA_DIGITS && mantissa <= MAX_EXACT_MANTISSA) {
+            double value = static_cast<double>(mantissa);
+            if (exponent == 0) {
+                return negative ? -value : value;
+            }
+            if (exponent < 0 && exponent >= -22) {
+                value /= EXACT_POWERS_OF_TEN[-exponent];
+                return negative ? -value : value;
+            }
+            if (exponent > 0 && exponent <= 22) {
+                value *= EXACT_POWERS_OF_TEN[exponent];
+                return negative ? -value : value;
+            }
+        }
+
+        // Everything else goes through from_chars, which is correctly rounded and locale-independent (libstdc++ 12+
+        // implements it with fast_float's Eisel-Lemire algorithm)
+        double value = 0;
+        const auto [ptr, ec] = std::from_chars(text.data(), end, value);
+        if (ec == std::errc::result_out_of_range && ptr == end && digits + exponent < 0) {
+            // Out of range below 1 means the value rounded to zero; from_chars leaves `value` alone then
+            return negative ? -0.0 : 0.0;
+        }
+        if (ec != std::errc() || ptr != end) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::optional<int64_t> parse_int64(std::string_view text) {
+        const char* p = text.data();
+        const char* const end = p + text.size();
+
+        const bool negative = p != end && *p == '-';
+        if (negative) {
+            ++p;
+        }
+        if (p == end || !is_digit(*p) || (*p == '0' && end - p > 1)) {
+            return std::nullopt;
+        }
+
+        // Accumulate as a negative number so INT64_MIN is reachable
+        int64_t value = 0;
+        for (; p != end; ++p) {
+            if (!is_digit(*p)) {
+                return std::nullopt;
+            }
+            const int digit = *p - '0';
+            if (value < (INT64_MIN + digit) / 10) {
+                return std::nullopt;
+            }
+            value = value * 10 - digit;
+        }
+        if (!negative) {
+            if (value == INT64_MIN) {
+                return std::nullopt;
+            }
+            return -value;
+        }
+        return value;
+    }
+
+} // namespace choochoo::json::number
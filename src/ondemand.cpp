@@ -0,0 +1,577 @@
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include "choochoo/fused_parser.hpp"
+#include "choochoo/number.hpp"
+#include "choochoo/ondemand.hpp"
+#include "choochoo/simd.hpp"
+
+namespace choochoo::json::ondemand {
+
+    namespace {
+        bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+        const char* skip_whitespace(const char* p, const char* end) {
+            if (p < end && !is_whitespace(*p)) {
+                return p;
+            }
+            size_t newlines = 0;
+            const char* line_start = nullptr;
+            return simd::skip_whitespace(p, end, newlines, line_start);
+        }
+
+        /// Move `p` from the opening quote of a string to just past its closing one. Returns false, leaving `p` at the
+        /// fault, for a raw control character or a string that is not terminated.
+        bool skip_string(const char*& p, const char* end, ErrorCode& error) {
+            const char* const quote = p++;
+            while (true) {
+                p = simd::find_string_special(p, end);
+                if (p == end) {
+                    p = quote;
+                    error = ErrorCode::UNTERMINATED_STRING;
+                    return false;
+                }
+                if (*p == '"') {
+                    ++p;
+                    return true;
+                }
+                if (*p == '\\' && ++p == end) {
+                    p = quote;
+                    error = ErrorCode::UNTERMINATED_STRING;
+                    return false;
+                }
+                if (static_cast<unsigned char>(*p) < 0x20) {
+                    error = ErrorCode::CONTROL_CHARACTER;
+                    return false;
+                }
+                ++p;
+            }
+        }
+
+        /// End of a number or literal: the next whitespace or structural character.
+        const char* scalar_end(const char* p, const char* end) {
+            while (p < end && !is_whitespace(*p) && *p != ',' && *p != ']' && *p != '}' && *p != ':') {
+                ++p;
+            }
+            return p;
+        }
+
+        /// Past the value starting at `p`, or nullptr if it runs off the end of the input.
+        const char* skip_value(const char* p, const char* end) {
+            if (p == end) {
+                return nullptr;
+            }
+            ErrorCode error{};
+            if (*p == '"') {
+                return skip_string(p, end, error) ? p : nullptr;
+            }
+            if (*p != '{' && *p != '[') {
+                const char* const scalar = scalar_end(p, end);
+                return scalar == p ? nullptr : scalar;
+            }
+            // Containers are skipped by depth alone; their contents are checked only when read
+            size_t depth = 0;
+            while (p < end) {
+                switch (*p) {
+                case '"':
+                    if (!skip_string(p, end, error)) {
+                        return nullptr;
+                    }
+                    continue;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                case '}':
+                case ']':
+                    if (--depth == 0) {
+                        return p + 1;
+                    }
+                    break;
+                default:
+                    break;
+                }
+                ++p;
+            }
+            return nullptr;
+        }
+
+        /// 1-based line and column of `at`.
+        std::pair<size_t, size_t> locate(const char* begin, const char* at) {
+            size_t line = 1;
+            const char* line_start = begin;
+            for (const char* p = begin; p < at; ++p) {
+                if (*p == '\n') {
+                    ++line;
+                    line_start = p + 1;
+                }
+            }
+            return {line, static_cast<size_t>(at - line_start + 1)};
+        }
+
+        /// The type of the token starting at `at`, judged from its first byte.
+        token::Type token_at(const char* at, const char* end) {
+            if (at == end) {
+                return token::Type::EOF_TOKEN;
+            }
+            switch (*at) {
+            case '{':
+                return token::Type::LBRACE;
+            case '}':
+                return token::Type::RBRACE;
+            case '[':
+                return token::Type::LBRACKET;
+            case ']':
+                return token::Type::RBRACKET;
+            case ',':
+                return token::Type::COMMA;
+            case ':':
+                return token::Type::COLON;
+            case '"':
+                return token::Type::STRING;
+            case 't':
+                return token::Type::TRUE;
+            case 'f':
+                return token::Type::FALSE;
+            case 'n':
+                return token::Type::NULL_VALUE;
+            default:
+                return *at == '-' || (*at >= '0' && *at <= '9') ? token::Type::NUMBER : token::Type::INVALID;
+            }
+        }
+
+        /// Error `code` found at `at`, located in the document starting at `begin`.
+        std::unexpected<Error> located(const char* begin, const char* end, const char* at, ErrorCode code) {
+            const auto [line, column] = locate(begin, at);
+            return std::unexpected(Error{code, token_at(at, end), static_cast<size_t>(at - begin), line, column});
+        }
+
+        /// `error`, returned for the text starting at `base`, relocated into the document starting at `begin`.
+        std::unexpected<Error> relocated(const char* begin, const char* base, Error error) {
+            const char* const at = base + error.offset;
+            error.offset = static_cast<size_t>(at - begin);
+            std::tie(error.line, error.column) = locate(begin, at);
+            return std::unexpected(error);
+        }
+
+        /// Move `p` from just past an element to the next one. Returns false at the closing `close`, and sets `error`
+        /// if neither a comma nor `close` follows.
+        bool next_element(const char*& p, const char* end, char close, std::optional<ErrorCode>& error) {
+            p = skip_whitespace(p, end);
+            if (p < end && *p == ',') {
+                p = skip_whitespace(p + 1, end);
+                return true;
+            }
+            if (p == end || *p != close) {
+                error = close == ']' ? ErrorCode::EXPECTED_ARRAY_END : ErrorCode::EXPECTED_OBJECT_END;
+            }
+            return false;
+        }
+
+        /// Read the key of the member at `p` and move `p` to its value, or to the fault if there is an error.
+        std::optional<ErrorCode> read_key(const char*& p, const char* end, std::string_view& key) {
+            if (p == end || *p != '"') {
+                return ErrorCode::EXPECTED_KEY;
+            }
+            const char* const key_begin = p;
+            if (ErrorCode error{}; !skip_string(p, end, error)) {
+                return error;
+            }
+            key = std::string_view(key_begin + 1, p - key_begin - 2);
+            p = skip_whitespace(p, end);
+            if (p == end || *p != ':') {
+                return ErrorCode::EXPECTED_COLON;
+            }
+            p = skip_whitespace(p + 1, end);
+            if (p == end) {
+                return ErrorCode::EXPECTED_VALUE;
+            }
+            return std::nullopt;
+        }
+
+        bool key_matches(std::string_view key, std::string_view name) {
+            if (key.find('\\') == std::string_view::npos) {
+                return key == name;
+            }
+            auto unescaped = unescape(key);
+            return unescaped && unescaped.value() == name;
+        }
+    } // namespace
+
+    Value::Value(const char* begin, const char* end, const char* pos, std::optional<ErrorCode> error) :
+        begin_(begin), end_(end), pos_(pos), error_(error) {}
+
+    bool Value::valid() const { return !error_; }
+
+    std::optional<Error> Value::error() const {
+        if (!error_) {
+            return std::nullopt;
+        }
+        return located(begin_, end_, pos_, *error_).error();
+    }
+
+    std::expected<Type, Error> Value::type() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        switch (pos_ < end_ ? *pos_ : '\0') {
+        case '{':
+            return Type::OBJECT;
+        case '[':
+            return Type::ARRAY;
+        case '"':
+            return Type::STRING;
+        case 't':
+        case 'f':
+            return Type::BOOLEAN;
+        case 'n':
+            return Type::NULL_VALUE;
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return Type::NUMBER;
+        default:
+            return located(begin_, end_, pos_, ErrorCode::EXPECTED_VALUE);
+        }
+    }
+
+    std::expected<int64_t, Error> Value::get_int64() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        auto integer = number::parse_int64(std::string_view(pos_, scalar_end(pos_, end_)));
+        if (!integer) {
+            return located(begin_, end_, pos_, ErrorCode::EXPECTED_INT64);
+        }
+        return *integer;
+    }
+
+    std::expected<double, Error> Value::get_double() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        auto num = number::parse_double(std::string_view(pos_, scalar_end(pos_, end_)));
+        if (!num) {
+            return located(begin_, end_, pos_, ErrorCode::EXPECTED_NUMBER);
+        }
+        return *num;
+    }
+
+    std::expected<bool, Error> Value::get_bool() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        const std::string_view word(pos_, scalar_end(pos_, end_));
+        if (word == "true") {
+            return true;
+        }
+        if (word == "false") {
+            return false;
+        }
+        return located(begin_, end_, pos_, ErrorCode::EXPECTED_BOOLEAN);
+    }
+
+    std::expected<bool, Error> Value::is_null() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        return std::string_view(pos_, scalar_end(pos_, end_)) == "null";
+    }
+
+    std::expected<std::string_view, Error> Value::get_raw_string() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        if (pos_ == end_ || *pos_ != '"') {
+            return located(begin_, end_, pos_, ErrorCode::EXPECTED_STRING);
+        }
+        const char* string_end = pos_;
+        if (ErrorCode error{}; !skip_string(string_end, end_, error)) {
+            return located(begin_, end_, string_end, error);
+        }
+        return std::string_view(pos_ + 1, string_end - pos_ - 2);
+    }
+
+    std::expected<std::string, Error> Value::get_string() const {
+        auto raw = get_raw_string();
+        if (!raw) {
+            return std::unexpected(raw.error());
+        }
+        auto text = unescape(raw.value());
+        if (!text) {
+            return relocated(begin_, raw.value().data(), text.error());
+        }
+        return std::move(text.value());
+    }
+
+    Array Value::get_array() const {
+        if (error_) {
+            return Array(begin_, end_, pos_, error_);
+        }
+        if (pos_ == end_ || *pos_ != '[') {
+            return Array(begin_, end_, pos_, ErrorCode::EXPECTED_ARRAY);
+        }
+        return Array(begin_, end_, skip_whitespace(pos_ + 1, end_));
+    }
+
+    Object Value::get_object() const {
+        if (error_) {
+            return Object(begin_, end_, pos_, error_);
+        }
+        if (pos_ == end_ || *pos_ != '{') {
+            return Object(begin_, end_, pos_, ErrorCode::EXPECTED_OBJECT);
+        }
+        return Object(begin_, end_, skip_whitespace(pos_ + 1, end_));
+    }
+
+    Value Value::find_field(std::string_view name) const { return get_object().find_field(name); }
+
+    Value Value::operator[](std::string_view name) const { return find_field(name); }
+
+    Value Value::at(size_t index) const { return get_array().at(index); }
+
+    std::expected<std::string_view, Error> Value::raw_json() const {
+        if (error_) {
+            return located(begin_, end_, pos_, *error_);
+        }
+        const char* const value_end = skip_value(pos_, end_);
+        if (value_end == nullptr) {
+            return located(begin_, end_, pos_, ErrorCode::MALFORMED_VALUE);
+        }
+        return std::string_view(pos_, value_end - pos_);
+    }
+
+    std::expected<json::Value, Error> Value::materialize(ParseOptions options) const {
+        auto text = raw_json();
+        if (!text) {
+            return std::unexpected(text.error());
+        }
+        auto value = FusedParser<>(text.value(), std::move(options)).parse();
+        if (!value) {
+            return relocated(begin_, text.value().data(), value.error());
+        }
+        return std::move(value.value());
+    }
+
+    std::expected<std::string, Error> Field::unescaped_key() const {
+        auto text = unescape(key);
+        if (!text) {
+            return relocated(value.begin_, key.data(), text.error());
+        }
+        return std::move(text.value());
+    }
+
+    Array::Array(const char* begin, const char* end, const char* first, std::optional<ErrorCode> error) :
+        begin_(begin), end_(end), first_(first), error_(error) {}
+
+    bool Array::valid() const { return !error_; }
+
+    std::optional<Error> Array::error() const {
+        if (!error_) {
+            return std::nullopt;
+        }
+        return located(begin_, end_, first_, *error_).error();
+    }
+
+    Value Array::at(size_t index) const {
+        for (const Value element : *this) {
+            if (!element.valid() || index-- == 0) {
+                return element;
+            }
+        }
+        return Value(begin_, end_, first_, ErrorCode::INDEX_OUT_OF_RANGE);
+    }
+
+    std::expected<size_t, Error> Array::count() const {
+        size_t count = 0;
+        for (const Value element : *this) {
+            if (!element.valid()) {
+                return located(begin_, end_, element.pos_, *element.error_);
+            }
+            ++count;
+        }
+        return count;
+    }
+
+    Array::iterator Array::begin() const { return iterator(begin_, end_, first_, error_); }
+
+    Array::iterator Array::end() const { return iterator(begin_, end_, nullptr, std::nullopt); }
+
+    Array::iterator::iterator(const char* begin, const char* end, const char* pos, std::optional<ErrorCode> error) :
+        begin_(begin), end_(end), pos_(pos), error_(error) {
+        if (pos_ != nullptr && !error_) {
+            if (pos_ == end_) {
+                error_ = ErrorCode::EXPECTED_ARRAY_END;
+            }
+            else if (*pos_ == ']') {
+                pos_ = nullptr;
+            }
+        }
+    }
+
+    Value Array::iterator::operator*() const { return Value(begin_, end_, pos_, error_); }
+
+    Array::iterator& Array::iterator::operator++() {
+        // A failed element is the last one
+        if (error_) {
+            pos_ = nullptr;
+            error_.reset();
+            return *this;
+        }
+        const char* next = skip_value(pos_, end_);
+        if (next == nullptr) {
+            error_ = ErrorCode::MALFORMED_VALUE;
+            return *this;
+        }
+        if (!next_element(next, end_, ']', error_)) {
+            pos_ = error_ ? next : nullptr;
+            return *this;
+        }
+        pos_ = next;
+        return *this;
+    }
+
+    bool Array::iterator::operator==(const iterator& other) const { return pos_ == other.pos_; }
+
+    Object::Object(const char* begin, const char* end, const char* first, std::optional<ErrorCode> error) :
+        begin_(begin), end_(end), first_(first), resume_(first), error_(error) {}
+
+    bool Object::valid() const { return !error_; }
+
+    std::optional<Error> Object::error() const {
+        if (!error_) {
+            return std::nullopt;
+        }
+        return located(begin_, end_, first_, *error_).error();
+    }
+
+    Value Object::find_field(std::string_view name) {
+        if (error_) {
+            return Value(begin_, end_, first_, error_);
+        }
+        // Scan from where the last lookup stopped to the end, then from the start back up to there
+        const char* const stop = resume_;
+        const char* p = resume_;
+        for (bool wrapped = false;; wrapped = true) {
+            while (p < end_ && *p != '}' && !(wrapped && p == stop)) {
+                std::string_view key;
+                if (const auto error = read_key(p, end_, key)) {
+                    return Value(begin_, end_, p, error);
+                }
+                const char* const value = p;
+                p = skip_value(value, end_);
+                if (p == nullptr) {
+                    return Value(begin_, end_, value, ErrorCode::MALFORMED_VALUE);
+                }
+                std::optional<ErrorCode> separator_error;
+                const bool more = next_element(p, end_, '}', separator_error);
+                if (separator_error) {
+                    return Value(begin_, end_, p, separator_error);
+                }
+                if (key_matches(key, name)) {
+                    resume_ = more ? p : first_;
+                    return Value(begin_, end_, value);
+                }
+                if (!more) {
+                    break;
+                }
+            }
+            if (p == end_) {
+                return Value(begin_, end_, p, ErrorCode::EXPECTED_OBJECT_END);
+            }
+            if (wrapped || stop == first_) {
+                return Value(begin_, end_, first_, ErrorCode::NO_SUCH_FIELD);
+            }
+            p = first_;
+        }
+    }
+
+    Value Object::operator[](std::string_view name) { return find_field(name); }
+
+    Object::iterator Object::begin() const { return iterator(begin_, end_, first_, error_); }
+
+    Object::iterator Object::end() const { return iterator(begin_, end_, nullptr, std::nullopt); }
+
+    Object::iterator::iterator(const char* begin, const char* end, const char* pos, std::optional<ErrorCode> error) :
+        begin_(begin), end_(end), pos_(pos), error_(error) {
+        if (pos_ != nullptr && !error_ && pos_ < end_ && *pos_ == '}') {
+            pos_ = nullptr;
+        }
+        read_member();
+    }
+
+    void Object::iterator::read_member() {
+        if (pos_ == nullptr) {
+            return;
+        }
+        if (!error_) {
+            const char* p = pos_;
+            std::string_view key;
+            error_ = read_key(p, end_, key);
+            if (!error_) {
+                field_ = Field{key, Value(begin_, end_, p)};
+                return;
+            }
+            pos_ = p;
+        }
+        field_ = Field{{}, Value(begin_, end_, pos_, error_)};
+    }
+
+    const Field& Object::iterator::operator*() const { return field_; }
+
+    const Field* Object::iterator::operator->() const { return &field_; }
+
+    Object::iterator& Object::iterator::operator++() {
+        // A failed member is the last one
+        if (error_) {
+            pos_ = nullptr;
+            error_.reset();
+            return *this;
+        }
+        const char* next = skip_value(field_.value.pos_, end_);
+        if (next == nullptr) {
+            pos_ = field_.value.pos_;
+            error_ = ErrorCode::MALFORMED_VALUE;
+        }
+        else if (next_element(next, end_, '}', error_)) {
+            pos_ = next;
+        }
+        else {
+            pos_ = error_ ? next : nullptr;
+        }
+        read_member();
+        return *this;
+    }
+
+    bool Object::iterator::operator==(const iterator& other) const { return pos_ == other.pos_; }
+
+    Document::Document(std::string_view source) : source_(source) {}
+
+    Value Document::root() const {
+        const char* const begin = source_.data();
+        const char* const end = begin + source_.size();
+        const char* const pos = skip_whitespace(begin, end);
+        if (pos == end) {
+            return Value(begin, end, pos, ErrorCode::UNEXPECTED_EOF);
+        }
+        return Value(begin, end, pos);
+    }
+
+    Value Document::find_field(std::string_view name) const { return root().find_field(name); }
+
+    Value Document::operator[](std::string_view name) const { return find_field(name); }
+
+    Value Document::at(size_t index) const { return root().at(index); }
+
+    std::string_view Document::source() const { return source_; }
+
+} // namespace choochoo::json::ondemand
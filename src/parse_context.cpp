@@ -0,0 +1,28 @@
+#include "choochoo/parse_context.hpp"
+
+namespace choochoo::json {
+
+    ParseContext::ParseContext(ParseOptions options) :
+        lexer_(std::string_view()), parser_(lexer_, std::move(options)) {}
+
+    std::expected<Value, Error> ParseContext::parse(std::string_view json) {
+        lexer_.reset(json);
+        parser_.reset();
+        return parser_.parse();
+    }
+
+    std::expected<void, Error> ParseContext::parse_into(std::string_view json, Value& out) {
+        parser_.recycle(std::move(out));
+        auto result = parse(json);
+        if (!result) {
+            return std::unexpected(result.error());
+        }
+        out = std::move(result.value());
+        return {};
+    }
+
+    void ParseContext::recycle(Value&& tree) { parser_.recycle(std::move(tree)); }
+
+    const std::shared_ptr<KeyTable>& ParseContext::key_table() const { return parser_.key_table(); }
+
+} // namespace choochoo::json
@@ -1,63 +1,129 @@
-#include <iostream>
-#include <sstream>
+#include <cstdint>
+#include <utility>
+#include "choochoo/number.hpp"
 #include "choochoo/parser.hpp"
 
 namespace choochoo::json {
 
-    const char* token_type_name(token::Type type) {
-        switch (type) {
-        case token::Type::STRING:
-            return "STRING";
-        case token::Type::NUMBER:
-            return "NUMBER";
-        case token::Type::TRUE:
-            return "TRUE";
-        case token::Type::FALSE:
-            return "FALSE";
-        case token::Type::NULL_VALUE:
-            return "NULL";
-        case token::Type::LBRACE:
-            return "LBRACE";
-        case token::Type::RBRACE:
-            return "RBRACE";
-        case token::Type::LBRACKET:
-            return "LBRACKET";
-        case token::Type::RBRACKET:
-            return "RBRACKET";
-        case token::Type::COMMA:
-            return "COMMA";
-        case token::Type::COLON:
-            return "COLON";
-        case token::Type::EOF_TOKEN:
-            return "EOF";
-        case token::Type::INVALID:
-            return "INVALID";
-        default:
-            return "UNKNOWN";
+    Token Parser::current_token() { return current_token_; }
+
+    void Parser::advance() {
+        if (index_ == nullptr) {
+            current_token_ = lexer_.get().next_token();
+            return;
+        }
+        const auto& offsets = index_->offsets();
+        const size_t position = index_pos_;
+        const size_t start = index_pos_ < offsets.size() ? offsets[index_pos_++] : SIZE_MAX;
+        const size_t end = index_pos_ < offsets.size() ? offsets[index_pos_] : SIZE_MAX;
+        current_token_ = lexer_.get().index_token(start, end, index_->has_escapes(position));
+        if (current_token_.type_ == token::Type::STRING) {
+            ++index_pos_; // closing quote
         }
     }
 
-    Token Parser::current_token() { return current_token_; }
+    // Index-driven tokens skip line/column bookkeeping, so recover it only when an error is reported
+    Error Parser::error_here(ErrorCode code) {
+        if (index_ != nullptr && current_token_.line == 0) {
+            auto [line, column] = lexer_.get().locate(current_token_.offset);
+            current_token_.line = line;
+            current_token_.column = column;
+        }
+        return Error{code, current_token_.type_, current_token_.offset, current_token_.line, current_token_.column};
+    }
 
-    void Parser::advance() { current_token_ = lexer_.get().next_token(); }
+    Error Parser::error_in_string(const Error& unescape_error) {
+        // Past the opening quote; string tokens hold no newlines before an escape worth reporting
+        Error error = error_here(unescape_error.code);
+        error.offset += 1 + unescape_error.offset;
+        error.column += 1 + unescape_error.offset;
+        return error;
+    }
 
-    std::expected<void, std::string> Parser::expect(token::Type expected) {
+    std::expected<void, Error> Parser::expect(token::Type expected) {
         if (current_token_.type_ != expected) {
-            return std::unexpected("Unexpected token at line " + std::to_string(current_token_.line) + ", column " +
-                                   std::to_string(current_token_.column) +
-                                   ". Expected: " + std::to_string(static_cast<int>(expected)) +
-                                   ", got: " + std::to_string(static_cast<int>(current_token_.type_)));
+            switch (expected) {
+            case token::Type::COLON:
+                return std::unexpected(error_here(ErrorCode::EXPECTED_COLON));
+            case token::Type::RBRACE:
+                return std::unexpected(error_here(ErrorCode::EXPECTED_OBJECT_END));
+            case token::Type::RBRACKET:
+                return std::unexpected(error_here(ErrorCode::EXPECTED_ARRAY_END));
+            default:
+                return std::unexpected(error_here(ErrorCode::UNEXPECTED_TOKEN));
+            }
         }
         advance();
         return {};
     }
 
-    std::expected<std::string, std::string> Parser::process_string(std::string_view raw_string) {
-        std::string result;
+    std::expected<std::string, Error> Parser::process_string(std::string_view raw_string) {
+        return unescape(raw_string);
+    }
+
+    // The code unit spelled by the four hex digits at `digits`, or -1
+    static long parse_hex4(std::string_view digits) {
+        if (digits.size() < 4) {
+            return -1;
+        }
+        long code = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const char c = digits[i];
+            code <<= 4;
+            if (c >= '0' && c <= '9') {
+                code |= c - '0';
+            }
+            else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            }
+            else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            }
+            else {
+                return -1;
+            }
+        }
+        return code;
+    }
+
+    template <typename Result>
+    static void append_utf8(Result& result, unsigned long code_point) {
+        if (code_point < 0x80) {
+            result += static_cast<char>(code_point);
+        }
+        else if (code_point < 0x800) {
+            result += static_cast<char>(0xC0 | (code_point >> 6));
+            result += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000) {
+            result += static_cast<char>(0xE0 | (code_point >> 12));
+            result += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else {
+            result += static_cast<char>(0xF0 | (code_point >> 18));
+            result += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            result += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            result += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    // Shared by both unescape() overloads; `result` is empty on entry
+    template <typename Result>
+    static std::expected<Result, Error> unescape_into(std::string_view raw_string, Result result) {
         result.reserve(raw_string.size());
 
         for (size_t i = 0; i < raw_string.size(); ++i) {
-            if (raw_string[i] == '\\' && i + 1 < raw_string.size()) {
+            // Copy everything up to the next escape in one go
+            const size_t escape = raw_string.find('\\', i);
+            if (escape == std::string_view::npos) {
+                result.append(raw_string.substr(i));
+                break;
+            }
+            result.append(raw_string.substr(i, escape - i));
+            i = escape;
+
+            if (i + 1 < raw_string.size()) {
                 switch (raw_string[i + 1]) {
                 case '"':
                     result += '"';
@@ -83,8 +149,31 @@ namespace choochoo::json {
                 case 't':
                     result += '\t';
                     break;
+                case 'u': {
+                    // \uXXXX, with characters outside the BMP as a UTF-16 surrogate pair, decoded to UTF-8
+                    unsigned long code_point = 0;
+                    const long unit = parse_hex4(raw_string.substr(i + 2));
+                    if (unit < 0 || (unit >= 0xDC00 && unit <= 0xDFFF)) {
+                        return std::unexpected(Error{ErrorCode::INVALID_UNICODE_ESCAPE, token::Type::STRING, i});
+                    }
+                    code_point = static_cast<unsigned long>(unit);
+                    i += 4;
+                    if (unit >= 0xD800 && unit <= 0xDBFF) {
+                        const bool escaped = raw_string.substr(i + 2, 2) == "\\u";
+                        const long low = escaped ? parse_hex4(raw_string.substr(i + 4)) : -1;
+                        if (low < 0xDC00 || low > 0xDFFF) {
+                            // Reported at the high surrogate, which has no partner
+                            const size_t high = i - 4;
+                            return std::unexpected(Error{ErrorCode::INVALID_UNICODE_ESCAPE, token::Type::STRING, high});
+                        }
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + static_cast<unsigned long>(low - 0xDC00);
+                        i += 6;
+                    }
+                    append_utf8(result, code_point);
+                    break;
+                }
                 default:
-                    return std::unexpected("Invalid escape sequence");
+                    return std::unexpected(Error{ErrorCode::INVALID_ESCAPE, token::Type::STRING, i});
                 }
                 ++i;
             }
@@ -95,184 +184,271 @@ namespace choochoo::json {
         return result;
     }
 
-
-    // Helper to extract string from Token.value variant
-    static std::string_view token_string_view(const Token& token) {
-        return (std::holds_alternative<std::string_view>(token.value)) ? std::get<std::string_view>(token.value)
-                                                                       : std::get<std::string>(token.value);
+    std::expected<std::string, Error> unescape(std::string_view raw_string) {
+        return unescape_into(raw_string, std::string());
     }
-} // namespace choochoo::json
 
-double choochoo::json::Parser::process_number(std::string_view number_str) {
-    try {
-        return std::stod(std::string(number_str));
+    std::expected<String, Error> unescape(std::string_view raw_string, std::pmr::memory_resource* resource) {
+        return unescape_into(raw_string, String(resource));
     }
-    catch (const std::exception&) {
-        throw std::runtime_error("Invalid number format");
+
+    std::expected<void, Error> unescape(std::string_view raw_string, std::string& out) {
+        out.clear();
+        auto result = unescape_into(raw_string, std::move(out));
+        if (!result) {
+            out.clear();
+            return std::unexpected(result.error());
+        }
+        out = std::move(result.value());
+        return {};
     }
+
+} // namespace choochoo::json
+
+std::optional<double> choochoo::json::Parser::process_number(std::string_view number_str) {
+    return number::parse_double(number_str);
 }
 
-std::expected<choochoo::json::Value, std::string> choochoo::json::Parser::parse_value() {
-    // std::cout << "[parse_value] current_token_: type=" << token_type_name(current_token_.type_) << ", value='"
-    //           << current_token_.value << "', line=" << current_token_.line << ", column=" <<
-    //           current_token_.column
-    //           << std::endl;
-    if (current_token_.type_ == token::Type::EOF_TOKEN) {
-        return std::unexpected("No value to parse (unexpected EOF)");
-    }
-    switch (current_token_.type_) {
-    case token::Type::STRING: {
-        auto processed_result = process_string(token_string_view(current_token_));
-        if (!processed_result)
-            return std::unexpected(processed_result.error());
-        std::string processed = std::move(processed_result.value());
+bool choochoo::json::Parser::begin_container(bool is_object, Value& value) {
+    const token::Type close = is_object ? token::Type::RBRACE : token::Type::RBRACKET;
+    if (current_token_.type_ == close) {
         advance();
-        return Value::string(std::move(processed));
+        value = is_object ? Value::object(Object(resource_)) : Value::array(Array(resource_));
+        return true;
     }
-    case token::Type::NUMBER: {
-        double num;
-        try {
-            num = process_number(token_string_view(current_token_));
+    Frame& frame = stack_.emplace_back(Frame{is_object, Array(resource_), Object(resource_)});
+    if (is_object) {
+        if (!pool_.objects.empty()) {
+            frame.object = std::move(pool_.objects.back());
+            pool_.objects.pop_back();
         }
-        catch (const std::exception&) {
-            std::ostringstream oss;
-            oss << "Invalid number format at line " << current_token_.line << ", column " << current_token_.column
-                << ". Value: '" << token_string_view(current_token_) << "'";
-            return std::unexpected(oss.str());
+        else {
+            // TODO: Profile typical object sizes and adjust reservation for optimal performance.
+            frame.object.reserve(8);
         }
-        advance();
-        return Value::number(num);
-    }
-    case token::Type::TRUE:
-        advance();
-        return Value::boolean(true);
-    case token::Type::FALSE:
-        advance();
-        return Value::boolean(false);
-    case token::Type::NULL_VALUE:
-        advance();
-        return Value::null();
-    case token::Type::LBRACE: {
-        auto expect_result = expect(token::Type::LBRACE);
-        if (!expect_result)
-            return std::unexpected(expect_result.error());
-        auto obj_result = parse_object_body();
-        if (!obj_result)
-            return std::unexpected(obj_result.error());
-        return obj_result;
     }
-    case token::Type::LBRACKET: {
-        auto expect_result = expect(token::Type::LBRACKET);
-        if (!expect_result)
-            return std::unexpected(expect_result.error());
-        auto arr_result = parse_array_body();
-        if (!arr_result)
-            return std::unexpected(arr_result.error());
-        return arr_result;
-    }
-    default: {
-        std::ostringstream oss;
-        oss << "Unexpected token '" << token_string_view(current_token_) << "' ("
-            << token_type_name(current_token_.type_) << ") at line " << current_token_.line << ", column "
-            << current_token_.column << ".";
-        return std::unexpected(oss.str());
+    else {
+        if (!pool_.arrays.empty()) {
+            frame.array = std::move(pool_.arrays.back());
+            pool_.arrays.pop_back();
+        }
+        else {
+            // TODO: Profile typical array sizes and adjust reservation for optimal performance.
+            frame.array.reserve(8);
+        }
     }
+    return false;
+}
+
+void choochoo::json::Parser::abandon_stack() {
+    while (!stack_.empty()) {
+        Frame& frame = stack_.back();
+        Value::recycle(frame.is_object ? Value::object(std::move(frame.object)) : Value::array(std::move(frame.array)),
+                       pool_);
+        stack_.pop_back();
     }
 }
 
-std::expected<choochoo::json::Value, std::string> choochoo::json::Parser::parse_object_body() {
-    std::unordered_map<const std::string*, Value> obj;
-    obj.reserve(8); // TODO: Profile typical object sizes and adjust reservation for optimal performance.
-    if (current_token_.type_ == token::Type::RBRACE) {
-        advance();
-        return Value::object(std::move(obj));
+std::expected<choochoo::json::Value, choochoo::json::Error>
+choochoo::json::Parser::parse_nested(std::optional<token::Type> opened) {
+    // Open containers live on stack_ rather than the call stack, so nesting depth costs heap, not stack frames
+    const auto fail = [this](const Error& error) -> std::expected<Value, Error> {
+        abandon_stack();
+        return std::unexpected(error);
+    };
+
+    Value value;
+    bool complete = false; // `value` holds a finished value still to be added to its container
+    if (opened) {
+        if (max_depth_ == 0)
+            return fail(error_here(ErrorCode::DEPTH_EXCEEDED));
+        complete = begin_container(*opened == token::Type::LBRACE, value);
     }
+
     while (true) {
-        if (current_token_.type_ != token::Type::STRING) {
-            std::ostringstream oss;
-            oss << "Expected string key in object, but found '" << token_string_view(current_token_) << "' ("
-                << token_type_name(current_token_.type_) << ") at line " << current_token_.line << ", column "
-                << current_token_.column << ".";
-            return std::unexpected(oss.str());
+        if (!complete) {
+            if (!stack_.empty() && stack_.back().is_object) {
+                // A key the lexer could not read, such as an unterminated one, is reported as what is wrong with it
+                if (current_token_.type_ == token::Type::INVALID)
+                    return fail(error_here(lexer_.get().invalid_reason()));
+                if (current_token_.type_ != token::Type::STRING)
+                    return fail(error_here(ErrorCode::EXPECTED_KEY));
+                // Intern key in pool and use pointer as map key; a key seen before is found without allocating
+                if (!current_token_.has_escapes) {
+                    stack_.back().key = key_table_->intern(current_token_.value);
+                }
+                else {
+                    auto key_result = process_string(current_token_.value);
+                    if (!key_result)
+                        return fail(error_in_string(key_result.error()));
+                    stack_.back().key = key_table_->intern(key_result.value());
+                }
+                advance();
+                auto expect_result = expect(token::Type::COLON);
+                if (!expect_result)
+                    return fail(expect_result.error());
+            }
+
+            switch (current_token_.type_) {
+            case token::Type::STRING: {
+                // Build the string straight in the tree's memory resource, skipping the escape pass when there is no
+                // backslash
+                if (!current_token_.has_escapes) {
+                    value = zero_copy_strings_ ? Value::borrowed_string(current_token_.value)
+                                               : Value::string(current_token_.value, resource_);
+                    advance();
+                    break;
+                }
+                auto processed_result = unescape(current_token_.value, resource_);
+                if (!processed_result)
+                    return fail(error_in_string(processed_result.error()));
+                advance();
+                value = Value::string(std::move(processed_result.value()));
+                break;
+            }
+            case token::Type::NUMBER: {
+                auto num = process_number(current_token_.value);
+                if (!num)
+                    return fail(error_here(ErrorCode::INVALID_NUMBER));
+                advance();
+                value = Value::number(*num);
+                break;
+            }
+            case token::Type::TRUE:
+                advance();
+                value = Value::boolean(true);
+                break;
+            case token::Type::FALSE:
+                advance();
+                value = Value::boolean(false);
+                break;
+            case token::Type::NULL_VALUE:
+                advance();
+                value = Value::null();
+                break;
+            case token::Type::LBRACE:
+            case token::Type::LBRACKET: {
+                // Checked at the opening bracket, before anything of the container is read
+                if (stack_.size() >= max_depth_)
+                    return fail(error_here(ErrorCode::DEPTH_EXCEEDED));
+                const bool is_object = current_token_.type_ == token::Type::LBRACE;
+                advance();
+                if (!begin_container(is_object, value)) {
+                    continue; // Parse its first element
+                }
+                break;
+            }
+            case token::Type::EOF_TOKEN:
+                return fail(error_here(ErrorCode::UNEXPECTED_EOF));
+            case token::Type::INVALID:
+                return fail(error_here(lexer_.get().invalid_reason()));
+            default:
+                return fail(error_here(ErrorCode::UNEXPECTED_TOKEN));
+            }
         }
-        auto key_result = process_string(token_string_view(current_token_));
-        if (!key_result)
-            return std::unexpected(key_result.error());
-        std::string key = std::move(key_result.value());
-        // Intern key in pool and use pointer as map key
-        auto [it, inserted] = key_pool_.insert(std::move(key));
-        const std::string* interned_key = &(*it);
-        advance();
-        auto expect_result = expect(token::Type::COLON);
-        if (!expect_result)
-            return std::unexpected(expect_result.error());
+        complete = false;
 
-        auto value_result = parse_value();
-        if (!value_result)
-            return std::unexpected(value_result.error());
-        obj.emplace(interned_key, std::move(value_result.value()));
+        // Add the value to the innermost container, closing every container it completes
+        while (true) {
+            if (stack_.empty()) {
+                return value;
+            }
+            Frame& frame = stack_.back();
+            if (frame.is_object) {
+                frame.object.emplace(frame.key, std::move(value));
+            }
+            else {
+                frame.array.emplace_back(std::move(value));
+            }
 
-        if (current_token_.type_ == token::Type::COMMA) {
-            advance();
-            continue;
-        }
-        else if (current_token_.type_ == token::Type::RBRACE) {
+            if (current_token_.type_ == token::Type::COMMA) {
+                advance();
+                break;
+            }
+            if (current_token_.type_ != (frame.is_object ? token::Type::RBRACE : token::Type::RBRACKET)) {
+                return fail(error_here(frame.is_object ? ErrorCode::EXPECTED_OBJECT_END
+                                                       : ErrorCode::EXPECTED_ARRAY_END));
+            }
             advance();
-            break;
-        }
-        else {
-            std::ostringstream oss;
-            oss << "Expected ',' or '}' in object, but found '" << token_string_view(current_token_) << "' ("
-                << token_type_name(current_token_.type_) << ") at line " << current_token_.line << ", column "
-                << current_token_.column << ".";
-            return std::unexpected(oss.str());
+            value = frame.is_object ? Value::object(std::move(frame.object)) : Value::array(std::move(frame.array));
+            stack_.pop_back();
         }
     }
-    return Value::object(std::move(obj));
 }
 
-std::expected<choochoo::json::Value, std::string> choochoo::json::Parser::parse_array_body() {
-    std::vector<Value> arr;
-    arr.reserve(8); // TODO: Profile typical array sizes and adjust reservation for optimal performance.
+std::expected<choochoo::json::Value, choochoo::json::Error> choochoo::json::Parser::parse_value() {
+    return parse_nested(std::nullopt);
+}
 
-    if (current_token_.type_ == token::Type::RBRACKET) {
-        advance();
-        return Value::array(std::move(arr));
-    }
+std::expected<choochoo::json::Value, choochoo::json::Error> choochoo::json::Parser::parse_object_body() {
+    return parse_nested(token::Type::LBRACE);
+}
 
-    while (true) {
-        auto value_result = parse_value();
-        if (!value_result)
-            return std::unexpected(value_result.error());
-        arr.emplace_back(std::move(value_result.value()));
+std::expected<choochoo::json::Value, choochoo::json::Error> choochoo::json::Parser::parse_array_body() {
+    return parse_nested(token::Type::LBRACKET);
+}
 
-        if (current_token_.type_ == token::Type::COMMA) {
-            advance();
-            continue;
-        }
-        else if (current_token_.type_ == token::Type::RBRACKET) {
-            advance();
-            break;
-        }
-        else {
-            std::ostringstream oss;
-            oss << "Expected ',' or ']' in array, but found '" << token_string_view(current_token_) << "' ("
-                << token_type_name(current_token_.type_) << ") at line " << current_token_.line << ", column "
-                << current_token_.column << ".";
-            return std::unexpected(oss.str());
-        }
-    }
-    return Value::array(std::move(arr));
+choochoo::json::Parser::Parser(Lexer& lexer, ParseOptions options) :
+    lexer_(lexer), owns_key_table_(options.key_table == nullptr),
+    key_table_(owns_key_table_ ? std::make_shared<KeyTable>() : std::move(options.key_table)),
+    resource_(options.memory_resource != nullptr ? options.memory_resource : std::pmr::get_default_resource()),
+    zero_copy_requested_(options.zero_copy_strings),
+    zero_copy_strings_(options.zero_copy_strings && !lexer.is_streaming()), max_depth_(options.max_depth) {
+    pool_.resource = resource_;
+    advance();
 }
 
-choochoo::json::Parser::Parser(Lexer& lexer) : lexer_(lexer) { advance(); }
+choochoo::json::Parser::Parser(Lexer& lexer, const StructuralIndex& index, ParseOptions options) :
+    lexer_(lexer), owns_key_table_(options.key_table == nullptr),
+    key_table_(owns_key_table_ ? std::make_shared<KeyTable>() : std::move(options.key_table)),
+    resource_(options.memory_resource != nullptr ? options.memory_resource : std::pmr::get_default_resource()),
+    zero_copy_requested_(options.zero_copy_strings),
+    zero_copy_strings_(options.zero_copy_strings && !lexer.is_streaming()), max_depth_(options.max_depth),
+    index_(&index) {
+    pool_.resource = resource_;
+    advance();
+}
 
-std::expected<choochoo::json::Value, std::string> choochoo::json::Parser::parse() {
+std::expected<choochoo::json::Value, choochoo::json::Error> choochoo::json::Parser::parse() {
     auto result = parse_value();
-    return (!result ? std::unexpected(result.error())
-                : (current_token_.type_ != token::Type::EOF_TOKEN)
-                ? std::unexpected("Unexpected content after JSON value")
-                : result);
+    if (!result)
+        return result;
+    // Checked separately so the tree is moved out rather than copied by a conditional expression
+    if (current_token_.type_ != token::Type::EOF_TOKEN)
+        return std::unexpected(error_here(ErrorCode::TRAILING_CONTENT));
+    return result;
+}
+
+std::expected<choochoo::json::Value, choochoo::json::Error> choochoo::json::Parser::parse_next() {
+    renew_key_table();
+    return parse_value();
+}
+
+bool choochoo::json::Parser::at_end() const { return current_token_.type_ == token::Type::EOF_TOKEN; }
+
+void choochoo::json::Parser::renew_key_table() {
+    if (owns_key_table_ && key_table_->size() >= PRIVATE_KEY_TABLE_LIMIT)
+        key_table_ = std::make_shared<KeyTable>();
 }
 
+void choochoo::json::Parser::reset() {
+    renew_key_table();
+    index_ = nullptr;
+    index_pos_ = 0;
+    zero_copy_strings_ = zero_copy_requested_ && !lexer_.get().is_streaming();
+    advance();
+}
+
+void choochoo::json::Parser::reset(const StructuralIndex& index) {
+    renew_key_table();
+    index_ = &index;
+    index_pos_ = 0;
+    zero_copy_strings_ = zero_copy_requested_ && !lexer_.get().is_streaming();
+    advance();
+}
+
+void choochoo::json::Parser::recycle(Value&& tree) { Value::recycle(std::move(tree), pool_); }
+
+const std::shared_ptr<choochoo::json::KeyTable>& choochoo::json::Parser::key_table() const { return key_table_; }
+
 // namespace choochoo::json
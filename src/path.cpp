@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <utility>
+#include "choochoo/path.hpp"
+
+namespace choochoo::json {
+
+    namespace {
+        /// The array index a reference token spells, or `fallback`. Like RFC 6901, only plain decimal digits without
+        /// leading zeros count; `-` (past the end) never matches an element.
+        size_t parse_index(std::string_view token, size_t fallback) {
+            if (token.empty() || (token.size() > 1 && token[0] == '0')) {
+                return fallback;
+            }
+            size_t index = 0;
+            const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), index);
+            if (error != std::errc() || end != token.data() + token.size()) {
+                return fallback;
+            }
+            return index;
+        }
+
+        std::unexpected<Error> path_error(ErrorCode code, size_t position) {
+            return std::unexpected(Error{code, token::Type::INVALID, position});
+        }
+    } // namespace
+
+    Path::Path(std::shared_ptr<KeyTable> key_table) : key_table_(std::move(key_table)) {}
+
+    void Path::add_step(std::string_view token, bool may_be_index) {
+        steps_.push_back(Step{key_table_->intern(token), may_be_index ? parse_index(token, NO_INDEX) : NO_INDEX});
+    }
+
+    std::expected<Path, Error> Path::pointer(std::string_view pointer, std::shared_ptr<KeyTable> key_table) {
+        Path path(key_table != nullptr ? std::move(key_table) : std::make_shared<KeyTable>());
+        if (pointer.empty()) {
+            return path;
+        }
+        if (pointer[0] != '/') {
+            return path_error(ErrorCode::POINTER_WITHOUT_SLASH, 0);
+        }
+
+        std::string token;
+        for (size_t pos = 1;; ++pos) {
+            const size_t next = std::min(pointer.find('/', pos), pointer.size());
+            token.clear();
+            for (; pos < next; ++pos) {
+                if (pointer[pos] != '~') {
+                    token += pointer[pos];
+                    continue;
+                }
+                const char escaped = pos + 1 < next ? pointer[pos + 1] : '\0';
+                if (escaped != '0' && escaped != '1') {
+                    return path_error(ErrorCode::INVALID_POINTER_ESCAPE, pos);
+                }
+                token += escaped == '0' ? '~' : '/';
+                ++pos;
+            }
+            path.add_step(token, true);
+            if (next == pointer.size()) {
+                return path;
+            }
+        }
+    }
+
+    std::expected<Path, Error> Path::dotted(std::string_view dotted, std::shared_ptr<KeyTable> key_table) {
+        Path path(key_table != nullptr ? std::move(key_table) : std::make_shared<KeyTable>());
+        if (dotted.empty()) {
+            return path;
+        }
+
+        size_t pos = 0;
+        while (true) {
+            // A member name, optional only before a leading index as in `[0].name`
+            const size_t name_end = std::min(dotted.find_first_of(".[", pos), dotted.size());
+            if (name_end > pos) {
+                path.add_step(dotted.substr(pos, name_end - pos), true);
+            }
+            else if (pos != 0 || name_end == dotted.size() || dotted[name_end] != '[') {
+                return path_error(ErrorCode::EMPTY_PATH_NAME, pos);
+            }
+            pos = name_end;
+
+            while (pos < dotted.size() && dotted[pos] == '[') {
+                const size_t close = dotted.find(']', pos);
+                if (close == std::string_view::npos) {
+                    return path_error(ErrorCode::UNTERMINATED_PATH_INDEX, pos);
+                }
+                const size_t index = parse_index(dotted.substr(pos + 1, close - pos - 1), NO_INDEX);
+                if (index == NO_INDEX) {
+                    return path_error(ErrorCode::INVALID_PATH_INDEX, pos + 1);
+                }
+                path.steps_.push_back(Step{nullptr, index});
+                pos = close + 1;
+            }
+
+            if (pos == dotted.size()) {
+                return path;
+            }
+            if (dotted[pos] != '.') {
+                return path_error(ErrorCode::EXPECTED_PATH_SEPARATOR, pos);
+            }
+            ++pos;
+        }
+    }
+
+    const Value* Path::find(const Value& root) const {
+        const Value* current = &root;
+        for (const Step& step : steps_) {
+            switch (current->type()) {
+            case Type::OBJECT: {
+                if (step.key == nullptr) {
+                    return nullptr;
+                }
+                const Object& object = current->as_object()->get();
+                const auto it = object.find(step.key);
+                if (it == object.end()) {
+                    return nullptr;
+                }
+                current = &it->second;
+                break;
+            }
+            case Type::ARRAY: {
+                const Array& array = current->as_array()->get();
+                if (step.index >= array.size()) {
+                    return nullptr;
+                }
+                current = &array[step.index];
+                break;
+            }
+            default:
+                return nullptr;
+            }
+        }
+        return current;
+    }
+
+    Value* Path::find(Value& root) const {
+        // Walks through the non-const accessors, so every container along the path is unshared before it is handed out
+        Value* current = &root;
+        for (const Step& step : steps_) {
+            switch (current->type()) {
+            case Type::OBJECT: {
+                if (step.key == nullptr) {
+                    return nullptr;
+                }
+                Object& object = current->as_object()->get();
+                const auto it = object.find(step.key);
+                if (it == object.end()) {
+                    return nullptr;
+                }
+                current = &it->second;
+                break;
+            }
+            case Type::ARRAY: {
+                if (step.index >= current->as_array()->get().size()) {
+                    return nullptr;
+                }
+                current = &current->begin()[static_cast<std::ptrdiff_t>(step.index)];
+                break;
+            }
+            default:
+                return nullptr;
+            }
+        }
+        return current;
+    }
+
+    size_t Path::size() const { return steps_.size(); }
+
+} // namespace choochoo::json
@@ -0,0 +1,28 @@
+#include "choochoo/sax.hpp"
+
+namespace choochoo::json::sax::detail {
+
+    Error error_at(const Token& token, ErrorCode code) {
+        return Error{code, token.type_, token.offset, token.line, token.column};
+    }
+
+    Error error_in_string(const Token& token, const Error& unescape_error) {
+        // Past the opening quote, as in Parser
+        Error error = error_at(token, unescape_error.code);
+        error.offset += 1 + unescape_error.offset;
+        error.column += 1 + unescape_error.offset;
+        return error;
+    }
+
+    Error no_value_at(const Lexer& lexer, const Token& token) {
+        switch (token.type_) {
+        case token::Type::EOF_TOKEN:
+            return error_at(token, ErrorCode::UNEXPECTED_EOF);
+        case token::Type::INVALID:
+            return error_at(token, lexer.invalid_reason());
+        default:
+            return error_at(token, ErrorCode::UNEXPECTED_TOKEN);
+        }
+    }
+
+} // namespace choochoo::json::sax::detail
@@ -0,0 +1,29 @@
+#include "choochoo/serialize.hpp"
+#include "choochoo/writer.hpp"
+
+namespace choochoo::json {
+
+    void serialize(const Value& value, std::string& out, SerializeOptions options) {
+        Writer(out, options).value(value);
+    }
+
+    void serialize_chunks(const Value& value, const std::function<void(std::string_view)>& sink,
+                          SerializeOptions options) {
+        Writer writer([&sink](std::string_view chunk) { sink(chunk); }, options);
+        writer.value(value);
+        writer.flush();
+    }
+
+    void serialize(const Value& value, std::ostream& out, SerializeOptions options) {
+        Writer writer(out, options);
+        writer.value(value);
+        writer.flush();
+    }
+
+    std::string dump(const Value& value, SerializeOptions options) {
+        std::string out;
+        serialize(value, out, options);
+        return out;
+    }
+
+} // namespace choochoo::json
@@ -0,0 +1,151 @@
+#include <bit>
+#include <cstdint>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#include "choochoo/simd.hpp"
+
+namespace choochoo::json::simd {
+
+    namespace {
+        bool is_string_special(char c) { return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20; }
+
+        /// The letter after the backslash for control characters with a short escape, 0 for those written as \u00XX.
+        constexpr char SHORT_ESCAPES[0x20] = {0, 0, 0, 0, 0, 0, 0, 0, 'b', 't', 'n', 0, 'f', 'r'};
+        constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+        bool is_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+        /// Fold one chunk's masks into the running newline count. Returns true if the chunk ends the run.
+        bool account_whitespace(const char* chunk, uint32_t whitespace, uint32_t newline, uint32_t full,
+                                const char*& stop, size_t& newlines, const char*& line_start) {
+            const uint32_t other = ~whitespace & full;
+            size_t run = std::countr_zero(other | ~full);
+            if (other != 0) {
+                newline &= (uint32_t{1} << run) - 1;
+            }
+            if (newline != 0) {
+                newlines += std::popcount(newline);
+                line_start = chunk + (31 - std::countl_zero(newline)) + 1;
+            }
+            stop = chunk + run;
+            return other != 0;
+        }
+    } // namespace
+
+    const char* find_string_special(const char* begin, const char* end) {
+        const char* p = begin;
+#if defined(__AVX2__)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control_max = _mm256_set1_epi8(0x1F);
+        for (; end - p >= 32; p += 32) {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            // Unsigned c <= 0x1F exactly when min(c, 0x1F) == c
+            const __m256i special =
+                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+                                _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk));
+            const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+            if (mask != 0) {
+                return p + std::countr_zero(mask);
+            }
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control_max = _mm_set1_epi8(0x1F);
+        for (; end - p >= 16; p += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            // Unsigned c <= 0x1F exactly when min(c, 0x1F) == c
+            const __m128i special =
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                             _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk));
+            const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                return p + std::countr_zero(mask);
+            }
+        }
+#endif
+        while (p < end && !is_string_special(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    void escape_string(std::string& out, std::string_view text) {
+        // Grow once for the common case of nothing to escape; escapes then only grow the string by amortised appends
+        out.reserve(out.size() + text.size() + 2);
+        out += '"';
+        const char* p = text.data();
+        const char* const end = p + text.size();
+        while (true) {
+            const char* special = find_string_special(p, end);
+            out.append(p, special);
+            if (special == end) {
+                break;
+            }
+            const auto c = static_cast<unsigned char>(*special);
+            if (c == '"' || c == '\\') {
+                const char escape[] = {'\\', static_cast<char>(c)};
+                out.append(escape, sizeof(escape));
+            }
+            else if (SHORT_ESCAPES[c] != 0) {
+                const char escape[] = {'\\', SHORT_ESCAPES[c]};
+                out.append(escape, sizeof(escape));
+            }
+            else {
+                const char escape[] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0xF]};
+                out.append(escape, sizeof(escape));
+            }
+            p = special + 1;
+        }
+        out += '"';
+    }
+
+    const char* skip_whitespace(const char* begin, const char* end, size_t& newlines, const char*& line_start) {
+        const char* p = begin;
+        const char* stop = begin;
+#if defined(__AVX2__)
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i lf = _mm256_set1_epi8('\n');
+        const __m256i cr = _mm256_set1_epi8('\r');
+        for (; end - p >= 32; p += 32) {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i is_lf = _mm256_cmpeq_epi8(chunk, lf);
+            const __m256i is_ws =
+                _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), is_lf),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, tab), _mm256_cmpeq_epi8(chunk, cr)));
+            const auto whitespace = static_cast<uint32_t>(_mm256_movemask_epi8(is_ws));
+            const auto newline = static_cast<uint32_t>(_mm256_movemask_epi8(is_lf));
+            if (account_whitespace(p, whitespace, newline, 0xFFFFFFFFu, stop, newlines, line_start)) {
+                return stop;
+            }
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        for (; end - p >= 16; p += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i is_lf = _mm_cmpeq_epi8(chunk, lf);
+            const __m128i is_ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), is_lf),
+                                               _mm_or_si128(_mm_cmpeq_epi8(chunk, tab), _mm_cmpeq_epi8(chunk, cr)));
+            const auto whitespace = static_cast<uint32_t>(_mm_movemask_epi8(is_ws));
+            const auto newline = static_cast<uint32_t>(_mm_movemask_epi8(is_lf));
+            if (account_whitespace(p, whitespace, newline, 0xFFFFu, stop, newlines, line_start)) {
+                return stop;
+            }
+        }
+#endif
+        for (; p < end && is_whitespace(*p); ++p) {
+            if (*p == '\n') {
+                ++newlines;
+                line_start = p + 1;
+            }
+        }
+        return p;
+    }
+
+} // namespace choochoo::json::simd
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#include "choochoo/structural_index.hpp"
+
+namespace choochoo::json {
+
+    namespace {
+        constexpr size_t BLOCK_SIZE = 64;
+
+        /// One bit per input byte of a 64-byte block.
+        struct BlockMasks {
+            uint64_t quote;
+            uint64_t backslash;
+            uint64_t op;
+            uint64_t whitespace;
+            uint64_t control; // Below 0x20, whitespace included
+        };
+
+#if defined(__AVX2__)
+        uint64_t match(__m256i lo, __m256i hi, char c) {
+            const __m256i needle = _mm256_set1_epi8(c);
+            const auto lo_bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+            const auto hi_bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+            return lo_bits | (static_cast<uint64_t>(hi_bits) << 32);
+        }
+
+        /// Bytes no greater than `c`, compared unsigned: c' <= c exactly when min(c', c) == c'.
+        uint64_t at_most(__m256i lo, __m256i hi, char c) {
+            const __m256i limit = _mm256_set1_epi8(c);
+            const auto lo_bits =
+                static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(lo, limit), lo)));
+            const auto hi_bits =
+                static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(hi, limit), hi)));
+            return lo_bits | (static_cast<uint64_t>(hi_bits) << 32);
+        }
+
+        BlockMasks classify(const char* block) {
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+            // Setting bit 0x20 folds '[' onto '{' and ']' onto '}'
+            const __m256i case_bit = _mm256_set1_epi8(0x20);
+            const __m256i lo_folded = _mm256_or_si256(lo, case_bit);
+            const __m256i hi_folded = _mm256_or_si256(hi, case_bit);
+            return BlockMasks{
+                match(lo, hi, '"'),
+                match(lo, hi, '\\'),
+                match(lo_folded, hi_folded, '{') | match(lo_folded, hi_folded, '}') | match(lo, hi, ':') |
+                    match(lo, hi, ','),
+                match(lo, hi, ' ') | match(lo, hi, '\t') | match(lo, hi, '\n') | match(lo, hi, '\r'),
+                at_most(lo, hi, 0x1F),
+            };
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        uint64_t match(const __m128i (&chunks)[4], char c) {
+            const __m128i needle = _mm_set1_epi8(c);
+            uint64_t bits = 0;
+            for (int i = 0; i < 4; ++i) {
+                const auto chunk_bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], needle)));
+                bits |= static_cast<uint64_t>(chunk_bits) << (16 * i);
+            }
+            return bits;
+        }
+
+        /// Bytes no greater than `c`, compared unsigned: c' <= c exactly when min(c', c) == c'.
+        uint64_t at_most(const __m128i (&chunks)[4], char c) {
+            const __m128i limit = _mm_set1_epi8(c);
+            uint64_t bits = 0;
+            for (int i = 0; i < 4; ++i) {
+                const __m128i clamped = _mm_min_epu8(chunks[i], limit);
+                const auto chunk_bits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(clamped, chunks[i])));
+                bits |= static_cast<uint64_t>(chunk_bits) << (16 * i);
+            }
+            return bits;
+        }
+
+        BlockMasks classify(const char* block) {
+            __m128i chunks[4];
+            __m128i folded[4];
+            // Setting bit 0x20 folds '[' onto '{' and ']' onto '}'
+            const __m128i case_bit = _mm_set1_epi8(0x20);
+            for (int i = 0; i < 4; ++i) {
+                chunks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+                folded[i] = _mm_or_si128(chunks[i], case_bit);
+            }
+            return BlockMasks{
+                match(chunks, '"'),
+                match(chunks, '\\'),
+                match(folded, '{') | match(folded, '}') | match(chunks, ':') | match(chunks, ','),
+                match(chunks, ' ') | match(chunks, '\t') | match(chunks, '\n') | match(chunks, '\r'),
+                at_most(chunks, 0x1F),
+            };
+        }
+#else
+        BlockMasks classify(const char* block) {
+            BlockMasks masks{};
+            for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                const uint64_t bit = uint64_t{1} << i;
+                if (static_cast<unsigned char>(block[i]) < 0x20) {
+                    masks.control |= bit;
+                }
+                switch (block[i]) {
+                case '"':
+                    masks.quote |= bit;
+                    break;
+                case '\\':
+                    masks.backslash |= bit;
+                    break;
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                    masks.op |= bit;
+                    break;
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    masks.whitespace |= bit;
+                    break;
+                default:
+                    break;
+                }
+            }
+            return masks;
+        }
+#endif
+
+        /// Bits of characters preceded by an odd-length run of backslashes. `prev_escaped` carries a dangling
+        /// backslash run across blocks.
+        uint64_t find_escaped(uint64_t backslash, uint64_t& prev_escaped) {
+            constexpr uint64_t EVEN_BITS = 0x5555555555555555ULL;
+            backslash &= ~prev_escaped;
+            const uint64_t follows_escape = (backslash << 1) | prev_escaped;
+            const uint64_t odd_sequence_starts = backslash & ~EVEN_BITS & ~follows_escape;
+            const uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+            prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts ? 1 : 0;
+            const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+            return (EVEN_BITS ^ invert_mask) & follows_escape;
+        }
+
+        /// Running XOR over the bits: every bit from an opening quote up to (excluding) its closing quote is set.
+        uint64_t prefix_xor(uint64_t bits) {
+            bits ^= bits << 1;
+            bits ^= bits << 2;
+            bits ^= bits << 4;
+            bits ^= bits << 8;
+            bits ^= bits << 16;
+            bits ^= bits << 32;
+            return bits;
+        }
+    } // namespace
+
+    std::expected<StructuralIndex, Error> StructuralIndex::build(std::string_view input) {
+        if (input.size() >= std::numeric_limits<uint32_t>::max()) {
+            return std::unexpected(Error{ErrorCode::INPUT_TOO_LARGE});
+        }
+
+        StructuralIndex index;
+        index.offsets_.reserve(input.size() / 4 + BLOCK_SIZE);
+
+        uint64_t prev_escaped = 0;
+        uint64_t prev_in_string = 0;
+        uint64_t prev_scalar = 0;
+        size_t open_string = 0; // Position of the last opening quote
+
+        char tail[BLOCK_SIZE];
+        for (size_t base = 0; base < input.size(); base += BLOCK_SIZE) {
+            const char* block = input.data() + base;
+            if (input.size() - base < BLOCK_SIZE) {
+                std::memset(tail, ' ', BLOCK_SIZE);
+                std::memcpy(tail, block, input.size() - base);
+                block = tail;
+            }
+
+            const BlockMasks masks = classify(block);
+            const uint64_t escaped = find_escaped(masks.backslash, prev_escaped);
+            const uint64_t quote = masks.quote & ~escaped;
+            const uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+            prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+            const uint64_t scalar = ~(masks.op | masks.whitespace | quote) & ~in_string;
+            const uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+            prev_scalar = scalar >> 63;
+
+            // Backslashes inside a string belong to the string opened last before them
+            uint64_t string_backslash = masks.backslash & in_string;
+            // Raw control characters inside strings are recorded too, for the parser to reject
+            uint64_t structurals = (masks.op & ~in_string) | quote | scalar_start | (masks.control & in_string);
+            while (structurals != 0) {
+                const int bit = std::countr_zero(structurals);
+                if (string_backslash != 0) {
+                    const uint64_t before = string_backslash & ((uint64_t{1} << bit) - 1);
+                    if (before != 0) {
+                        index.mark_escapes(open_string);
+                        string_backslash &= ~before;
+                    }
+                }
+                if ((quote & in_string) >> bit & 1) {
+                    open_string = index.offsets_.size();
+                }
+                index.offsets_.push_back(static_cast<uint32_t>(base + bit));
+                structurals &= structurals - 1;
+            }
+            if (string_backslash != 0) {
+                index.mark_escapes(open_string); // The string continues into the next block
+            }
+        }
+
+        if (prev_in_string != 0) {
+            // Located only now that it failed, so building the index never counts lines
+            const size_t offset = index.offsets_[open_string];
+            const std::string_view before = input.substr(0, offset);
+            const size_t line_start = before.rfind('\n') + 1; // npos + 1 == 0 on the first line
+            return std::unexpected(Error{ErrorCode::UNTERMINATED_STRING, token::Type::STRING, offset,
+                                         static_cast<size_t>(std::ranges::count(before, '\n')) + 1,
+                                         offset - line_start + 1});
+        }
+        return index;
+    }
+
+    const std::vector<uint32_t>& StructuralIndex::offsets() const { return offsets_; }
+
+    size_t StructuralIndex::size() const { return offsets_.size(); }
+
+    bool StructuralIndex::has_escapes(size_t position) const {
+        const size_t word = position / 64;
+        return word < escapes_.size() && (escapes_[word] >> (position % 64) & 1) != 0;
+    }
+
+    void StructuralIndex::mark_escapes(size_t position) {
+        const size_t word = position / 64;
+        if (word >= escapes_.size()) {
+            escapes_.resize(word + 1);
+        }
+        escapes_[word] |= uint64_t{1} << (position % 64);
+    }
+
+} // namespace choochoo::json
@@ -1,21 +1,299 @@
-#include <cstdio>
-#include <sstream>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include "choochoo/serialize.hpp"
 #include "choochoo/value.hpp"
 
 namespace choochoo::json {
 
+    namespace {
+        // Returned by operator[] for missing members
+        const Value NULL_MEMBER;
+
+        // A string or container lives in a box allocated from the same memory resource as its contents
+        template <typename T, typename... Args>
+        T* box(std::pmr::memory_resource* resource, Args&&... args) {
+            void* memory = resource->allocate(sizeof(T), alignof(T));
+            try {
+                return new (memory) T(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                resource->deallocate(memory, sizeof(T), alignof(T));
+                throw;
+            }
+        }
+
+        template <typename T>
+        void unbox(T* boxed) {
+            std::pmr::memory_resource* resource = boxed->get_allocator().resource();
+            boxed->~T();
+            resource->deallocate(boxed, sizeof(T), alignof(T));
+        }
+
+        // Explicit stacks for walking a tree start in a buffer on the call stack and only go to the heap when deep
+        constexpr size_t INLINE_WALK_BYTES = 512;
+
+        // Whether a container holds a borrowed string anywhere in it
+        enum class Borrows : uint8_t { NO, YES, UNKNOWN };
+    } // namespace
+
+    template <typename T>
+    struct Value::Shared {
+        std::atomic<uint32_t> refs{1};
+        // Cached borrows() of the elements; reset whenever a non-const accessor hands the container out
+        mutable std::atomic<Borrows> borrows{Borrows::UNKNOWN};
+        T value;
+
+        template <typename... Args>
+        explicit Shared(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+        [[nodiscard]] typename T::allocator_type get_allocator() const { return value.get_allocator(); }
+
+        [[nodiscard]] bool holds_borrowed() const {
+            const Borrows state = borrows.load(std::memory_order_relaxed);
+            if (state != Borrows::UNKNOWN) {
+                return state == Borrows::YES;
+            }
+            // The scan only updates the mutable cache
+            Storage storage;
+            if constexpr (std::is_same_v<T, Array>) {
+                storage.array = const_cast<Shared*>(this);
+                return scan_borrows(Type::ARRAY, storage);
+            }
+            else {
+                storage.object = const_cast<Shared*>(this);
+                return scan_borrows(Type::OBJECT, storage);
+            }
+        }
+
+        /// A container shared on copy must already live where a deep copy would put it, so sharing never ties a copy
+        /// to an arena or an input buffer.
+        [[nodiscard]] bool shareable() const {
+            return value.get_allocator().resource() == std::pmr::get_default_resource() && !holds_borrowed();
+        }
+
+        /// `shared` if its Value is the only owner, otherwise a copy of it in the same resource, which the caller then
+        /// owns instead of its reference to `shared`.
+        static Shared* unique(Shared* shared) {
+            if (shared->refs.load(std::memory_order_acquire) != 1) {
+                std::pmr::memory_resource* resource = shared->value.get_allocator().resource();
+                return box<Shared>(resource, shared->value, resource);
+            }
+            shared->borrows.store(Borrows::UNKNOWN, std::memory_order_relaxed);
+            return shared;
+        }
+
+        /// Drop one reference; true if it was the last, so the caller must free the container.
+        bool drop_reference() { return refs.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+    };
+
+    Object::Object() = default;
+
+    Object::Object(std::pmr::memory_resource* resource) : members_(resource), index_(resource) {}
+
+    Object::~Object() = default;
+
+    Object::Object(const Object& other) = default;
+
+    Object::Object(const Object& other, std::pmr::memory_resource* resource) :
+        members_(other.members_, resource), index_(other.index_, resource), key_table_(other.key_table_) {}
+
+    Object::Object(Object&& other) noexcept = default;
+
+    Object& Object::operator=(const Object& other) = default;
+
+    Object& Object::operator=(Object&& other) noexcept = default;
+
+    Object::allocator_type Object::get_allocator() const { return members_.get_allocator(); }
+
+    size_t Object::size() const { return members_.size(); }
+
+    bool Object::empty() const { return members_.empty(); }
+
+    void Object::reserve(size_t count) { members_.reserve(count); }
+
+    void Object::clear() {
+        members_.clear();
+        index_.clear();
+        key_table_.reset();
+    }
+
+    size_t Object::find_position(const Key* key) const {
+        if (key->table() != key_table_.get()) {
+            return find_position(*key, key->hash());
+        }
+        if (index_.empty()) {
+            for (size_t i = 0; i < members_.size(); ++i) {
+                if (members_[i].first == key) {
+                    return i;
+                }
+            }
+            return members_.size();
+        }
+        const size_t mask = index_.size() - 1;
+        for (size_t slot = key->hash() & mask;; slot = (slot + 1) & mask) {
+            const uint32_t entry = index_[slot];
+            if (entry == 0) {
+                return members_.size();
+            }
+            if (members_[entry - 1].first == key) {
+                return entry - 1;
+            }
+        }
+    }
+
+    size_t Object::find_position(std::string_view name, size_t hash) const {
+        // Comparing the stored hashes first means the text is only compared for the member that matches
+        if (index_.empty()) {
+            for (size_t i = 0; i < members_.size(); ++i) {
+                const Key* key = members_[i].first;
+                if (key->hash() == hash && *key == name) {
+                    return i;
+                }
+            }
+            return members_.size();
+        }
+        const size_t mask = index_.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            const uint32_t entry = index_[slot];
+            if (entry == 0) {
+                return members_.size();
+            }
+            const Key* key = members_[entry - 1].first;
+            if (key->hash() == hash && *key == name) {
+                return entry - 1;
+            }
+        }
+    }
+
+    void Object::build_index() {
+        // At most half full after a rebuild, so probe sequences stay short
+        index_.assign(std::bit_ceil(members_.size() * 4), 0);
+        const size_t mask = index_.size() - 1;
+        for (size_t i = 0; i < members_.size(); ++i) {
+            size_t slot = members_[i].first->hash() & mask;
+            while (index_[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            index_[slot] = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    const Key* Object::adopt(const Key* key) {
+        if (key_table_ == nullptr) {
+            // Bind to the first table seen; members added with keys of their own move to it
+            key_table_ = key->table()->retain();
+            for (auto& member : members_) {
+                member.first = key_table_->intern(*member.first);
+            }
+            return key;
+        }
+        return key_table_->intern(*key);
+    }
+
+    std::pair<Object::iterator, bool> Object::emplace(const Key* key, Value value) {
+        if (key->table() != key_table_.get()) {
+            key = adopt(key);
+        }
+        const size_t position = find_position(key);
+        if (position != members_.size()) {
+            return {members_.begin() + static_cast<std::ptrdiff_t>(position), false};
+        }
+        members_.emplace_back(key, std::move(value));
+
+        if (!index_.empty() && members_.size() * 2 <= index_.size()) {
+            const size_t mask = index_.size() - 1;
+            size_t slot = key->hash() & mask;
+            while (index_[slot] != 0) {
+                slot = (slot + 1) & mask;
+            }
+            index_[slot] = static_cast<uint32_t>(members_.size());
+        }
+        else if (members_.size() > LINEAR_SEARCH_LIMIT) {
+            build_index();
+        }
+        return {members_.end() - 1, true};
+    }
+
+    Object::iterator Object::find(const Key* key) {
+        return members_.begin() + static_cast<std::ptrdiff_t>(find_position(key));
+    }
+
+    Object::const_iterator Object::find(const Key* key) const {
+        return members_.begin() + static_cast<std::ptrdiff_t>(find_position(key));
+    }
+
+    bool Object::contains(const Key* key) const { return find_position(key) != members_.size(); }
+
+    Value& Object::at(const Key* key) {
+        const size_t position = find_position(key);
+        if (position == members_.size()) {
+            throw std::out_of_range("Object has no such key");
+        }
+        return members_[position].second;
+    }
+
+    const Value& Object::at(const Key* key) const {
+        const size_t position = find_position(key);
+        if (position == members_.size()) {
+            throw std::out_of_range("Object has no such key");
+        }
+        return members_[position].second;
+    }
+
+    Object::iterator Object::find(std::string_view name) {
+        return members_.begin() + static_cast<std::ptrdiff_t>(find_position(name, Key::hash_of(name)));
+    }
+
+    Object::const_iterator Object::find(std::string_view name) const {
+        return members_.begin() + static_cast<std::ptrdiff_t>(find_position(name, Key::hash_of(name)));
+    }
+
+    bool Object::contains(std::string_view name) const {
+        return find_position(name, Key::hash_of(name)) != members_.size();
+    }
+
+    Value& Object::at(std::string_view name) {
+        const size_t position = find_position(name, Key::hash_of(name));
+        if (position == members_.size()) {
+            throw std::out_of_range("Object has no member '" + std::string(name) + "'");
+        }
+        return members_[position].second;
+    }
+
+    const Value& Object::at(std::string_view name) const {
+        const size_t position = find_position(name, Key::hash_of(name));
+        if (position == members_.size()) {
+            throw std::out_of_range("Object has no member '" + std::string(name) + "'");
+        }
+        return members_[position].second;
+    }
+
+    Object::iterator Object::begin() { return members_.begin(); }
+
+    Object::iterator Object::end() { return members_.end(); }
+
+    Object::const_iterator Object::begin() const { return members_.begin(); }
+
+    Object::const_iterator Object::end() const { return members_.end(); }
+
     Value::Value() : type_(Type::NULL_VALUE) {}
 
     Value::~Value() {
         switch (type_) {
         case Type::STRING:
-            storage_.string.~basic_string();
+            if (string_kind_ == StringKind::OWNED) {
+                unbox(storage_.string);
+            }
             break;
         case Type::OBJECT:
-            storage_.object.~unordered_map();
-            break;
         case Type::ARRAY:
-            storage_.array.~vector();
+            release(type_, storage_);
             break;
         case Type::BOOLEAN:
         case Type::NUMBER:
@@ -25,6 +303,9 @@ namespace choochoo::json {
     }
 
     Value::Value(const Value& other) : type_(other.type_) {
+        // Copies go to the default resource, which is where copying a pmr container puts its contents too, unless
+        // the container is already there and can be shared
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource();
         switch (type_) {
         case Type::BOOLEAN:
             storage_.boolean = other.storage_.boolean;
@@ -32,41 +313,162 @@ namespace choochoo::json {
         case Type::NUMBER:
             storage_.number = other.storage_.number;
             break;
-        case Type::STRING:
-            new (&storage_.string) std::string(other.storage_.string);
+        case Type::STRING: {
+            // Copies own their text, even when the original borrows it
+            const std::string_view text = other.as_string().value();
+            if (text.size() <= INLINE_STRING_CAPACITY) {
+                set_inline_string(text);
+            }
+            else {
+                string_kind_ = StringKind::OWNED;
+                storage_.string = box<String>(resource, text, resource);
+            }
             break;
+        }
         case Type::ARRAY:
-            new (&storage_.array) std::vector(other.storage_.array);
-            break;
         case Type::OBJECT:
-            new (&storage_.object) std::unordered_map(other.storage_.object);
+            if (other.shareable()) {
+                if (type_ == Type::ARRAY) {
+                    other.storage_.array->refs.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    other.storage_.object->refs.fetch_add(1, std::memory_order_relaxed);
+                }
+                storage_ = other.storage_;
+            }
+            else {
+                Value copy = deep_copy(other, resource);
+                storage_ = copy.storage_;
+                copy.type_ = Type::NULL_VALUE;
+            }
             break;
         case Type::NULL_VALUE:
             break;
         }
     }
 
-    Value::Value(Value&& other) noexcept : type_(other.type_) {
-        switch (type_) {
-        case Type::STRING:
-            new (&storage_.string) std::string(std::move(other.storage_.string));
-            break;
-        case Type::ARRAY:
-            new (&storage_.array) std::vector(std::move(other.storage_.array));
-            break;
-        case Type::OBJECT:
-            new (&storage_.object) std::unordered_map(std::move(other.storage_.object));
-            break;
-        case Type::BOOLEAN:
-            storage_.boolean = other.storage_.boolean;
-            break;
-        case Type::NUMBER:
-            storage_.number = other.storage_.number;
-            break;
-        case Type::NULL_VALUE:
-        default:
-            break;
+    bool Value::shareable() const {
+        return type_ == Type::ARRAY ? storage_.array->shareable() : storage_.object->shareable();
+    }
+
+    Value Value::deep_copy(const Value& source, std::pmr::memory_resource* resource) {
+        // Elements are copied directly, except nested containers that cannot be shared: those are added as null
+        // placeholders and filled in from the stack. Each container is reserved to its final size before its
+        // elements are added, so the placeholders never move.
+        struct Frame {
+            const Value* source;
+            Value* target;
+        };
+        std::array<std::byte, INLINE_WALK_BYTES> buffer;
+        std::pmr::monotonic_buffer_resource walk(buffer.data(), buffer.size());
+        std::pmr::vector<Frame> stack(&walk);
+
+        Value root; // Owns everything built so far, should an allocation fail
+        stack.push_back({&source, &root});
+        while (!stack.empty()) {
+            const Frame frame = stack.back();
+            stack.pop_back();
+            const auto deferred = [](const Value& element) {
+                return (element.type_ == Type::ARRAY || element.type_ == Type::OBJECT) && !element.shareable();
+            };
+
+            if (frame.source->type_ == Type::ARRAY) {
+                const Array& elements = frame.source->storage_.array->value;
+                auto* copy = box<Shared<Array>>(resource, resource);
+                frame.target->type_ = Type::ARRAY;
+                frame.target->storage_.array = copy;
+                // Copies of the elements own their strings, so the copy borrows nothing
+                copy->borrows.store(Borrows::NO, std::memory_order_relaxed);
+                copy->value.reserve(elements.size());
+                for (const Value& element : elements) {
+                    if (deferred(element)) {
+                        stack.push_back({&element, &copy->value.emplace_back()});
+                    }
+                    else {
+                        copy->value.push_back(element);
+                    }
+                }
+            }
+            else {
+                const Object& members = frame.source->storage_.object->value;
+                auto* copy = box<Shared<Object>>(resource, resource);
+                frame.target->type_ = Type::OBJECT;
+                frame.target->storage_.object = copy;
+                copy->borrows.store(Borrows::NO, std::memory_order_relaxed);
+                copy->value.reserve(members.size());
+                for (const auto& [key, member] : members) {
+                    if (deferred(member)) {
+                        stack.push_back({&member, &copy->value.emplace(key, Value()).first->second});
+                    }
+                    else {
+                        copy->value.emplace(key, member);
+                    }
+                }
+            }
+        }
+        return root;
+    }
+
+    void Value::release(Type type, Storage storage) noexcept {
+        const auto drop_reference = [](Type container_type, Storage container) {
+            return container_type == Type::ARRAY ? container.array->drop_reference()
+                                                 : container.object->drop_reference();
+        };
+        if (!drop_reference(type, storage)) {
+            return;
+        }
+
+        // Freeing a container destroys its elements, which would recurse once per level. Instead its nested
+        // containers are released first, depth first from an explicit stack, so by the time a container is freed
+        // nothing nested is left in it.
+        struct Frame {
+            Type type;
+            Storage storage;
+            size_t next; // Next element to look at
+        };
+        std::array<std::byte, INLINE_WALK_BYTES> buffer;
+        std::pmr::monotonic_buffer_resource walk(buffer.data(), buffer.size());
+        std::pmr::vector<Frame> stack(&walk);
+
+        stack.push_back({type, storage, 0});
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            const bool is_array = frame.type == Type::ARRAY;
+            const size_t size = is_array ? frame.storage.array->value.size() : frame.storage.object->value.size();
+            Value* last_owner = nullptr;
+            while (frame.next < size && last_owner == nullptr) {
+                const auto index = static_cast<std::ptrdiff_t>(frame.next++);
+                Value& element = is_array ? frame.storage.array->value.begin()[index]
+                                          : frame.storage.object->value.begin()[index].second;
+                if (element.type_ != Type::ARRAY && element.type_ != Type::OBJECT) {
+                    continue;
+                }
+                if (drop_reference(element.type_, element.storage_)) {
+                    last_owner = &element;
+                }
+                else {
+                    element.type_ = Type::NULL_VALUE; // Its reference is already dropped
+                }
+            }
+            if (last_owner != nullptr) {
+                const Frame nested{last_owner->type_, last_owner->storage_, 0};
+                last_owner->type_ = Type::NULL_VALUE;
+                stack.push_back(nested); // Invalidates `frame`
+                continue;
+            }
+            if (is_array) {
+                unbox(frame.storage.array);
+            }
+            else {
+                unbox(frame.storage.object);
+            }
+            stack.pop_back();
         }
+    }
+
+    Value::Value(Value&& other) noexcept :
+        type_(other.type_), string_kind_(other.string_kind_), string_length_(other.string_length_),
+        storage_(other.storage_) {
         other.type_ = Type::NULL_VALUE;
     }
 
@@ -102,27 +504,195 @@ namespace choochoo::json {
         return v;
     }
 
-    Value Value::string(std::string s) {
+    void Value::set_inline_string(std::string_view s) {
+        string_kind_ = StringKind::INLINE;
+        string_length_ = static_cast<uint32_t>(s.size());
+        std::memcpy(storage_.inline_chars, s.data(), s.size());
+    }
+
+    Value Value::string(String s) {
+        Value v;
+        v.type_ = Type::STRING;
+        if (s.size() <= INLINE_STRING_CAPACITY) {
+            v.set_inline_string(s);
+        }
+        else {
+            v.string_kind_ = StringKind::OWNED;
+            v.storage_.string = box<String>(s.get_allocator().resource(), std::move(s));
+        }
+        return v;
+    }
+
+    Value Value::string(std::string_view s, std::pmr::memory_resource* resource) {
+        Value v;
+        v.type_ = Type::STRING;
+        if (s.size() <= INLINE_STRING_CAPACITY) {
+            v.set_inline_string(s);
+        }
+        else {
+            v.string_kind_ = StringKind::OWNED;
+            v.storage_.string = box<String>(resource, s, resource);
+        }
+        return v;
+    }
+
+    Value Value::borrowed_string(std::string_view s) {
+        // The length has to fit the 32-bit field; anything longer is copied
+        if (s.size() > std::numeric_limits<uint32_t>::max()) {
+            return string(s, std::pmr::get_default_resource());
+        }
         Value v;
         v.type_ = Type::STRING;
-        new (&v.storage_.string) std::string(std::move(s));
+        v.string_kind_ = StringKind::BORROWED;
+        v.string_length_ = static_cast<uint32_t>(s.size());
+        v.storage_.borrowed = s.data();
         return v;
     }
 
-    Value Value::array(std::vector<Value> arr) {
+    Value Value::array(Array arr) {
         Value v;
         v.type_ = Type::ARRAY;
-        new (&v.storage_.array) std::vector(std::move(arr));
+        v.storage_.array = box<Shared<Array>>(arr.get_allocator().resource(), std::move(arr));
+        // Worked out up front from the elements, so copying the finished tree never has to scan it
+        static_cast<void>(v.storage_.array->holds_borrowed());
         return v;
     }
 
-    Value Value::object(std::unordered_map<const std::string*, Value> obj) {
+    Value Value::object(Object obj) {
         Value v;
         v.type_ = Type::OBJECT;
-        new (&v.storage_.object) std::unordered_map(std::move(obj));
+        v.storage_.object = box<Shared<Object>>(obj.get_allocator().resource(), std::move(obj));
+        static_cast<void>(v.storage_.object->holds_borrowed());
         return v;
     }
 
+    void Value::recycle(Value&& tree, ContainerPool& pool) {
+        // Containers are taken apart from an explicit stack of the values still to visit, as in release()
+        std::array<std::byte, INLINE_WALK_BYTES> buffer;
+        std::pmr::monotonic_buffer_resource walk(buffer.data(), buffer.size());
+        std::pmr::vector<Value> pending(&walk);
+
+        pending.push_back(std::move(tree));
+        while (!pending.empty()) {
+            // Once emptied, its container is freed along with it
+            Value value = std::move(pending.back());
+            pending.pop_back();
+            if (value.type_ == Type::ARRAY) {
+                Shared<Array>* shared = value.storage_.array;
+                if (shared->refs.load(std::memory_order_acquire) != 1 ||
+                    shared->get_allocator().resource() != pool.resource) {
+                    continue;
+                }
+                for (Value& element : shared->value) {
+                    if (element.type_ == Type::ARRAY || element.type_ == Type::OBJECT) {
+                        pending.push_back(std::move(element));
+                    }
+                }
+                Array& array = pool.arrays.emplace_back(std::move(shared->value));
+                array.clear();
+            }
+            else if (value.type_ == Type::OBJECT) {
+                Shared<Object>* shared = value.storage_.object;
+                if (shared->refs.load(std::memory_order_acquire) != 1 ||
+                    shared->get_allocator().resource() != pool.resource) {
+                    continue;
+                }
+                for (auto& [key, element] : shared->value) {
+                    if (element.type_ == Type::ARRAY || element.type_ == Type::OBJECT) {
+                        pending.push_back(std::move(element));
+                    }
+                }
+                Object& object = pool.objects.emplace_back(std::move(shared->value));
+                object.clear();
+            }
+        }
+    }
+
+    bool Value::scan_borrows(Type type, Storage storage) {
+        // Nested containers whose answer is not cached are scanned from an explicit stack, as in release(), so a
+        // deep tree does not recurse. Every container on the stack encloses the one on top of it, so a borrowed
+        // string makes all of them borrow; a container scanned to the end borrows nothing.
+        struct Frame {
+            Type type;
+            Storage storage;
+            size_t next; // Next element to look at
+        };
+        const auto cached = [](Type container_type, Storage container) -> std::atomic<Borrows>& {
+            return container_type == Type::ARRAY ? container.array->borrows : container.object->borrows;
+        };
+        std::array<std::byte, INLINE_WALK_BYTES> buffer;
+        std::pmr::monotonic_buffer_resource walk(buffer.data(), buffer.size());
+        std::pmr::vector<Frame> stack(&walk);
+
+        stack.push_back({type, storage, 0});
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            const bool is_array = frame.type == Type::ARRAY;
+            const size_t size = is_array ? frame.storage.array->value.size() : frame.storage.object->value.size();
+            const Value* unscanned = nullptr;
+            bool borrowed = false;
+            while (frame.next < size && unscanned == nullptr && !borrowed) {
+                const auto index = static_cast<std::ptrdiff_t>(frame.next++);
+                const Value& element = is_array ? frame.storage.array->value.begin()[index]
+                                                : frame.storage.object->value.begin()[index].second;
+                if (element.type_ == Type::STRING) {
+                    borrowed = element.string_kind_ == StringKind::BORROWED;
+                }
+                else if (element.type_ == Type::ARRAY || element.type_ == Type::OBJECT) {
+                    const Borrows state = cached(element.type_, element.storage_).load(std::memory_order_relaxed);
+                    borrowed = state == Borrows::YES;
+                    if (state == Borrows::UNKNOWN) {
+                        unscanned = &element;
+                    }
+                }
+            }
+            // Concurrent readers may both work this out; they store the same answers
+            if (borrowed) {
+                for (const Frame& enclosing : stack) {
+                    cached(enclosing.type, enclosing.storage).store(Borrows::YES, std::memory_order_relaxed);
+                }
+                return true;
+            }
+            if (unscanned != nullptr) {
+                stack.push_back({unscanned->type_, unscanned->storage_, 0}); // Invalidates `frame`
+                continue;
+            }
+            cached(frame.type, frame.storage).store(Borrows::NO, std::memory_order_relaxed);
+            stack.pop_back();
+        }
+        return false;
+    }
+
+    bool Value::borrows() const {
+        switch (type_) {
+        case Type::STRING:
+            return string_kind_ == StringKind::BORROWED;
+        case Type::ARRAY:
+            return storage_.array->holds_borrowed();
+        case Type::OBJECT:
+            return storage_.object->holds_borrowed();
+        default:
+            return false;
+        }
+    }
+
+    void Value::unshare() {
+        // A copy replaces this value's reference to the shared container, which is dropped afterwards
+        const Storage shared = storage_;
+        if (type_ == Type::ARRAY) {
+            storage_.array = Shared<Array>::unique(storage_.array);
+            if (storage_.array != shared.array) {
+                release(type_, shared);
+            }
+        }
+        else if (type_ == Type::OBJECT) {
+            storage_.object = Shared<Object>::unique(storage_.object);
+            if (storage_.object != shared.object) {
+                release(type_, shared);
+            }
+        }
+    }
+
     Type Value::type() const { return type_; }
 
     std::optional<double> Value::as_number() const {
@@ -139,178 +709,147 @@ namespace choochoo::json {
         return storage_.boolean;
     }
 
-    std::optional<std::reference_wrapper<const std::string>> Value::as_string() const {
+    std::optional<std::string_view> Value::as_string() const {
         if (type_ != Type::STRING) {
             return std::nullopt;
         }
-        return std::ref(storage_.string);
+        switch (string_kind_) {
+        case StringKind::BORROWED:
+            return std::string_view(storage_.borrowed, string_length_);
+        case StringKind::INLINE:
+            return std::string_view(storage_.inline_chars, string_length_);
+        case StringKind::OWNED:
+        default:
+            return std::string_view(*storage_.string);
+        }
     }
 
-    std::optional<std::reference_wrapper<const std::vector<Value>>> Value::as_array() {
+    std::optional<std::reference_wrapper<const Array>> Value::as_array() {
         if (type_ != Type::ARRAY) {
             return std::nullopt;
         }
-        return std::ref(storage_.array);
+        return std::ref(storage_.array->value);
     }
 
-    std::optional<std::reference_wrapper<const std::vector<Value>>> Value::as_array() const {
+    std::optional<std::reference_wrapper<const Array>> Value::as_array() const {
         if (type_ != Type::ARRAY) {
             return std::nullopt;
         }
-        return std::cref(storage_.array);
+        return std::cref(storage_.array->value);
     }
 
-    std::optional<std::reference_wrapper<std::unordered_map<const std::string*, Value>>> Value::as_object() {
+    std::optional<std::reference_wrapper<Object>> Value::as_object() {
         if (type_ != Type::OBJECT) {
             return std::nullopt;
         }
-        return std::ref(storage_.object);
+        unshare();
+        return std::ref(storage_.object->value);
     }
 
-    std::optional<std::reference_wrapper<const std::unordered_map<const std::string*, Value>>>
+    std::optional<std::reference_wrapper<const Object>>
     Value::as_object() const {
         if (type_ != Type::OBJECT) {
             return std::nullopt;
         }
-        return std::cref(storage_.object);
+        return std::cref(storage_.object->value);
+    }
+
+    Value* Value::find(std::string_view name) {
+        if (type_ != Type::OBJECT)
+            return nullptr;
+        unshare();
+        auto it = storage_.object->value.find(name);
+        return it != storage_.object->value.end() ? &it->second : nullptr;
+    }
+
+    const Value* Value::find(std::string_view name) const {
+        if (type_ != Type::OBJECT)
+            return nullptr;
+        auto it = storage_.object->value.find(name);
+        return it != storage_.object->value.end() ? &it->second : nullptr;
+    }
+
+    Value& Value::at(std::string_view name) {
+        if (type_ != Type::OBJECT)
+            throw std::logic_error("Value is not an object");
+        unshare();
+        return storage_.object->value.at(name);
+    }
+
+    const Value& Value::at(std::string_view name) const {
+        if (type_ != Type::OBJECT)
+            throw std::logic_error("Value is not an object");
+        return storage_.object->value.at(name);
+    }
+
+    const Value& Value::operator[](std::string_view name) const {
+        const Value* member = find(name);
+        return member != nullptr ? *member : NULL_MEMBER;
     }
 
     /// Pretty-print the value with indentation.
     /// @param indent The number of spaces to indent the output.
     /// @return A string representation of the value with indentation.
     std::string Value::pretty(int indent) const {
-        const std::string indent_str(indent, ' ');
-        const std::string indent_next(indent + 2, ' ');
-
-        switch (type_) {
-        case Type::NULL_VALUE:
-            return "null";
-        case Type::BOOLEAN:
-            return storage_.boolean ? "true" : "false";
-        case Type::NUMBER: {
-            std::ostringstream oss;
-            oss << storage_.number;
-            return oss.str();
-        }
-        case Type::STRING: {
-            std::string out = "\"";
-            for (char c : storage_.string) {
-                switch (c) {
-                case '\"':
-                    out += "\\\"";
-                    break;
-                case '\\':
-                    out += "\\\\";
-                    break;
-                case '\b':
-                    out += "\\b";
-                    break;
-                case '\f':
-                    out += "\\f";
-                    break;
-                case '\n':
-                    out += "\\n";
-                    break;
-                case '\r':
-                    out += "\\r";
-                    break;
-                case '\t':
-                    out += "\\t";
-                    break;
-                default:
-                    if (static_cast<unsigned char>(c) < 0x20) {
-                        out += "\\u";
-                        char buf[5];
-                        snprintf(buf, sizeof(buf), "%04x", c);
-                        out += buf;
-                    }
-                    else {
-                        out += c;
-                    }
-                }
+        std::string out = dump(*this, SerializeOptions{.indent = 2});
+        if (indent > 0) {
+            // Every line after the first continues at the caller's indentation
+            const std::string margin(static_cast<size_t>(indent), ' ');
+            for (size_t pos = out.find('\n'); pos != std::string::npos; pos = out.find('\n', pos + 1)) {
+                out.insert(pos + 1, margin);
             }
-            out += "\"";
-            return out;
-        }
-        case Type::ARRAY: {
-            const auto& arr = storage_.array;
-            if (arr.empty())
-                return "[]";
-            std::string out = "[\n";
-            for (size_t i = 0; i < arr.size(); ++i) {
-                out += indent_next + arr[i].pretty(indent + 2);
-                if (i + 1 < arr.size())
-                    out += ",";
-                out += "\n";
-            }
-            out += indent_str + "]";
-            return out;
-        }
-        case Type::OBJECT: {
-            const auto& obj = storage_.object;
-            if (obj.empty())
-                return "{}";
-            std::string out = "{\n";
-            size_t i = 0;
-            for (const auto& [key, value] : obj) {
-                out += indent_next + "\"" + *key + "\": " + value.pretty(indent + 2);
-                if (i + 1 < obj.size())
-                    out += ",";
-                out += "\n";
-                ++i;
-            }
-            out += indent_str + "}";
-            return out;
-        }
-        default:
-            return "";
         }
+        return out;
     }
 
     // --- Iterator support ---
 
     // Array iterators
-    std::vector<Value>::iterator Value::begin() {
+    Array::iterator Value::begin() {
         if (type_ != Type::ARRAY)
             throw std::logic_error("Value is not an array");
-        return storage_.array.begin();
+        unshare();
+        return storage_.array->value.begin();
     }
-    std::vector<Value>::iterator Value::end() {
+    Array::iterator Value::end() {
         if (type_ != Type::ARRAY)
             throw std::logic_error("Value is not an array");
-        return storage_.array.end();
+        unshare();
+        return storage_.array->value.end();
     }
-    std::vector<Value>::const_iterator Value::begin() const {
+    Array::const_iterator Value::begin() const {
         if (type_ != Type::ARRAY)
             throw std::logic_error("Value is not an array");
-        return storage_.array.begin();
+        return storage_.array->value.begin();
     }
-    std::vector<Value>::const_iterator Value::end() const {
+    Array::const_iterator Value::end() const {
         if (type_ != Type::ARRAY)
             throw std::logic_error("Value is not an array");
-        return storage_.array.end();
+        return storage_.array->value.end();
     }
 
     // Object iterators
-    std::unordered_map<const std::string*, Value>::iterator Value::obj_begin() {
+    Object::iterator Value::obj_begin() {
         if (type_ != Type::OBJECT)
             throw std::logic_error("Value is not an object");
-        return storage_.object.begin();
+        unshare();
+        return storage_.object->value.begin();
     }
-    std::unordered_map<const std::string*, Value>::iterator Value::obj_end() {
+    Object::iterator Value::obj_end() {
         if (type_ != Type::OBJECT)
             throw std::logic_error("Value is not an object");
-        return storage_.object.end();
+        unshare();
+        return storage_.object->value.end();
     }
-    std::unordered_map<const std::string*, Value>::const_iterator Value::obj_begin() const {
+    Object::const_iterator Value::obj_begin() const {
         if (type_ != Type::OBJECT)
             throw std::logic_error("Value is not an object");
-        return storage_.object.begin();
+        return storage_.object->value.begin();
     }
-    std::unordered_map<const std::string*, Value>::const_iterator Value::obj_end() const {
+    Object::const_iterator Value::obj_end() const {
         if (type_ != Type::OBJECT)
             throw std::logic_error("Value is not an object");
-        return storage_.object.end();
+        return storage_.object->value.end();
     }
 
 } // namespace choochoo::json
@@ -0,0 +1,308 @@
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+#include "choochoo/simd.hpp"
+#include "choochoo/writer.hpp"
+
+namespace choochoo::json {
+
+    namespace {
+#ifdef NDEBUG
+        constexpr bool CHECK_STRUCTURE = false;
+#else
+        constexpr bool CHECK_STRUCTURE = true;
+#endif
+
+        void check(bool condition, const char* message) {
+            if constexpr (CHECK_STRUCTURE) {
+                if (!condition) {
+                    throw std::logic_error(message);
+                }
+            }
+        }
+    } // namespace
+
+    Writer::Writer(std::string& out, SerializeOptions options) : out_(out), indent_(options.indent) {}
+
+    Writer::Writer(std::function<void(std::string_view)> sink, SerializeOptions options) :
+        out_(buffer_), sink_(std::move(sink)), indent_(options.indent) {
+        buffer_.reserve(SERIALIZE_CHUNK_SIZE);
+    }
+
+    Writer::Writer(int fd, SerializeOptions options) :
+        Writer(
+            [this, fd](std::string_view chunk) {
+                while (!chunk.empty()) {
+#if defined(__unix__) || defined(__APPLE__)
+                    const ssize_t written = ::write(fd, chunk.data(), chunk.size());
+                    if (written < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (written < 0) {
+                        error_ = std::string("Cannot write to file descriptor: ") + std::strerror(errno);
+                        return;
+                    }
+#else
+                    const int written = ::_write(fd, chunk.data(), static_cast<unsigned>(chunk.size()));
+                    if (written < 0) {
+                        error_ = "Cannot write to file descriptor";
+                        return;
+                    }
+#endif
+                    chunk.remove_prefix(static_cast<size_t>(written));
+                }
+            },
+            options) {}
+
+    Writer::Writer(std::ostream& out, SerializeOptions options) :
+        Writer(
+            [this, &out](std::string_view chunk) {
+                if (!out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()))) {
+                    error_ = "Cannot write to stream";
+                }
+            },
+            options) {}
+
+    Writer::~Writer() { flush(); }
+
+    void Writer::newline(size_t depth) {
+        out_ += '\n';
+        out_.append(depth * static_cast<size_t>(indent_), ' ');
+    }
+
+    void Writer::before_value() {
+        check(!done_, "Writer: a document has a single root value");
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (!scopes_.empty()) {
+            check(scopes_.back() == Scope::ARRAY, "Writer: object members need a key()");
+            if (!first_) {
+                out_ += ',';
+            }
+            first_ = false;
+            if (indent_ > 0) {
+                newline(scopes_.size());
+            }
+        }
+    }
+
+    void Writer::after_value() {
+        if (scopes_.empty()) {
+            done_ = true;
+        }
+        if (sink_ && out_.size() >= SERIALIZE_CHUNK_SIZE) {
+            flush();
+        }
+    }
+
+    void Writer::write_string(std::string_view text) { simd::escape_string(out_, text); }
+
+    void Writer::write_double(double number) {
+        // JSON has no NaN or infinity
+        if (!std::isfinite(number)) {
+            out_ += "null";
+            return;
+        }
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        out_.append(buffer, result.ptr);
+    }
+
+    void Writer::write_integer(int64_t number) {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        out_.append(buffer, result.ptr);
+    }
+
+    void Writer::write_unsigned(uint64_t number) {
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        out_.append(buffer, result.ptr);
+    }
+
+    Writer& Writer::begin_object() {
+        before_value();
+        out_ += '{';
+        scopes_.push_back(Scope::OBJECT);
+        first_ = true;
+        return *this;
+    }
+
+    Writer& Writer::begin_array() {
+        before_value();
+        out_ += '[';
+        scopes_.push_back(Scope::ARRAY);
+        first_ = true;
+        return *this;
+    }
+
+    void Writer::end_scope(Scope scope, char close) {
+        check(!scopes_.empty() && scopes_.back() == scope, close == '}' ? "Writer: end_object() does not match"
+                                                                         : "Writer: end_array() does not match");
+        check(!after_key_, "Writer: a key() is missing its value");
+        if (!scopes_.empty()) {
+            scopes_.pop_back();
+        }
+        if (indent_ > 0 && !first_) {
+            newline(scopes_.size());
+        }
+        out_ += close;
+        // The closed container is an element of its parent, which is therefore not empty
+        first_ = false;
+        after_value();
+    }
+
+    Writer& Writer::end_object() {
+        end_scope(Scope::OBJECT, '}');
+        return *this;
+    }
+
+    Writer& Writer::end_array() {
+        end_scope(Scope::ARRAY, ']');
+        return *this;
+    }
+
+    Writer& Writer::key(std::string_view name) {
+        check(!scopes_.empty() && scopes_.back() == Scope::OBJECT, "Writer: key() outside an object");
+        check(!after_key_, "Writer: key() where a value is due");
+        if (!first_) {
+            out_ += ',';
+        }
+        first_ = false;
+        if (indent_ > 0) {
+            newline(scopes_.size());
+        }
+        write_string(name);
+        out_ += indent_ > 0 ? ": " : ":";
+        after_key_ = true;
+        return *this;
+    }
+
+    Writer& Writer::value(std::string_view text) {
+        before_value();
+        write_string(text);
+        after_value();
+        return *this;
+    }
+
+    Writer& Writer::value(const char* text) { return value(std::string_view(text)); }
+
+    Writer& Writer::value(double number) {
+        before_value();
+        write_double(number);
+        after_value();
+        return *this;
+    }
+
+    Writer& Writer::value(bool boolean) {
+        before_value();
+        out_ += boolean ? "true" : "false";
+        after_value();
+        return *this;
+    }
+
+    Writer& Writer::null() {
+        before_value();
+        out_ += "null";
+        after_value();
+        return *this;
+    }
+
+    Writer& Writer::value(const Value& tree) {
+        // Walks the tree from an explicit stack of open containers, so nesting depth does not use the call stack
+        struct Frame {
+            const Value* container;
+            size_t next; // Next element to write
+        };
+        std::vector<Frame> stack;
+        const Value* current = &tree;
+        while (true) {
+            switch (current->type()) {
+            case Type::NULL_VALUE:
+                null();
+                break;
+            case Type::BOOLEAN:
+                value(current->as_boolean().value());
+                break;
+            case Type::NUMBER:
+                value(current->as_number().value());
+                break;
+            case Type::STRING:
+                value(current->as_string().value());
+                break;
+            case Type::ARRAY:
+                begin_array();
+                stack.push_back({current, 0});
+                break;
+            case Type::OBJECT:
+                begin_object();
+                stack.push_back({current, 0});
+                break;
+            }
+
+            // The next element of the innermost open container, closing those that are finished
+            current = nullptr;
+            while (current == nullptr && !stack.empty()) {
+                Frame& frame = stack.back();
+                if (frame.container->type() == Type::ARRAY) {
+                    const Array& elements = frame.container->as_array()->get();
+                    if (frame.next < elements.size()) {
+                        current = &elements[frame.next++];
+                        continue;
+                    }
+                    stack.pop_back();
+                    end_array();
+                }
+                else {
+                    const Object& members = frame.container->as_object()->get();
+                    if (frame.next < members.size()) {
+                        const auto& [name, member] = members.begin()[static_cast<std::ptrdiff_t>(frame.next++)];
+                        key(*name);
+                        current = &member;
+                        continue;
+                    }
+                    stack.pop_back();
+                    end_object();
+                }
+            }
+            if (current == nullptr) {
+                return *this;
+            }
+        }
+    }
+
+    void Writer::flush() {
+        if (!sink_ || out_.empty()) {
+            return;
+        }
+        // After an error the rest of the output is dropped rather than written with a hole in it
+        if (error_.empty()) {
+            sink_(out_);
+        }
+        out_.clear();
+    }
+
+    std::expected<void, std::string> Writer::finish() {
+        flush();
+        if (!error_.empty()) {
+            return std::unexpected(error_);
+        }
+        if (!complete()) {
+            return std::unexpected("Writer: the document is incomplete");
+        }
+        return {};
+    }
+
+    bool Writer::complete() const { return done_; }
+
+} // namespace choochoo::json
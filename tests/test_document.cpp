@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "choochoo/json.hpp"
+
+namespace {
+    std::string write_temp_file(const std::string& name, const std::string& contents) {
+        auto path = std::filesystem::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary);
+        out << contents;
+        return path.string();
+    }
+} // namespace
+
+TEST_CASE("parse_file parses a mapped file and keeps keys alive") {
+    std::string json = R"({"name": "Mapped", "values": [1, 2, 3], "nested": {"ok": true}})";
+    auto path = write_temp_file("choochoo_json_document_test.json", json);
+
+    auto document = choochoo::json::parse_file(path);
+    std::remove(path.c_str());
+    REQUIRE(document);
+    REQUIRE(document->source() == json);
+
+    const auto& root = document->root();
+    REQUIRE(root.type() == choochoo::json::Type::OBJECT);
+    std::string keys;
+    for (const auto& [key, value] : root.as_object()->get()) {
+        keys += *key;
+    }
+    REQUIRE(keys == "namevaluesnested");
+    REQUIRE(root["name"].as_string().value() == "Mapped");
+    REQUIRE(root["nested"]["ok"].as_boolean() == true);
+
+    // Strings without escapes are views into the mapping
+    const auto name = root["name"].as_string().value();
+    REQUIRE(name.data() >= document->source().data());
+    REQUIRE(name.data() < document->source().data() + document->source().size());
+}
+
+TEST_CASE("parse_file reports missing, empty and malformed files") {
+    auto missing = choochoo::json::parse_file("/nonexistent/choochoo_json_missing.json");
+    REQUIRE_FALSE(missing);
+    REQUIRE(missing.error().code == choochoo::json::ErrorCode::FILE_OPEN_FAILED);
+    REQUIRE(missing.error().system_error == ENOENT);
+    REQUIRE(missing.error().message().starts_with("Cannot open file: "));
+
+    auto empty_path = write_temp_file("choochoo_json_document_empty.json", "");
+    auto empty = choochoo::json::parse_file(empty_path);
+    std::remove(empty_path.c_str());
+    REQUIRE_FALSE(empty);
+
+    auto bad_path = write_temp_file("choochoo_json_document_bad.json", R"({"a": })");
+    auto bad = choochoo::json::parse_file(bad_path);
+    std::remove(bad_path.c_str());
+    REQUIRE_FALSE(bad);
+    REQUIRE(bad.error().code == choochoo::json::ErrorCode::UNEXPECTED_TOKEN);
+    REQUIRE(bad.error().offset == 6);
+}
@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "choochoo/json.hpp"
+
+namespace {
+    /// Each document as its compact JSON, or "error", with the input bytes it covers.
+    std::vector<std::pair<std::string, std::string>> read_all(choochoo::json::DocumentStream& stream,
+                                                              std::string_view input) {
+        std::vector<std::pair<std::string, std::string>> documents;
+        for (auto& document : stream) {
+            const std::string text = document.value ? choochoo::json::dump(document.value.value()) : "error";
+            documents.emplace_back(text, std::string(input.substr(document.begin, document.end - document.begin)));
+        }
+        return documents;
+    }
+} // namespace
+
+TEST_CASE("A document stream reads newline-delimited JSON one document at a time") {
+    const std::string input = "{\"a\": 1}\n[2, 3]\n\n  \"x\"\n";
+    choochoo::json::DocumentStream stream(input);
+    const auto documents = read_all(stream, input);
+    REQUIRE(documents.size() == 3);
+    REQUIRE(documents[0] == std::pair<std::string, std::string>(R"({"a":1})", R"({"a": 1})"));
+    REQUIRE(documents[1] == std::pair<std::string, std::string>("[2,3]", "[2, 3]"));
+    REQUIRE(documents[2] == std::pair<std::string, std::string>(R"("x")", R"("x")"));
+    REQUIRE_FALSE(stream.next());
+}
+
+TEST_CASE("A document stream reads concatenated JSON and empty input") {
+    const std::string input = R"({"a":1}{"b":2} 3 true)";
+    choochoo::json::DocumentStream stream(input);
+    const auto documents = read_all(stream, input);
+    REQUIRE(documents.size() == 4);
+    REQUIRE(documents[1].second == R"({"b":2})");
+    REQUIRE(documents[3].first == "true");
+
+    choochoo::json::DocumentStream empty(" \n\t\n");
+    REQUIRE(empty.begin() == empty.end());
+}
+
+TEST_CASE("A document stream reports a malformed document and moves on") {
+    const std::string input = "{\"a\": 1\n{\"b\": 2}\n[1 2]\n4\n";
+    choochoo::json::DocumentStream stream(input);
+
+    // Cut short by the line break, so the next line is read as a document of its own
+    auto truncated = stream.next();
+    REQUIRE(truncated);
+    REQUIRE_FALSE(truncated->value);
+    REQUIRE(truncated->value.error().code == choochoo::json::ErrorCode::EXPECTED_OBJECT_END);
+    REQUIRE(truncated->value.error().line == 2);
+    REQUIRE(input.substr(truncated->begin, truncated->end - truncated->begin) == "{\"a\": 1\n");
+
+    auto next = stream.next();
+    REQUIRE(next);
+    REQUIRE(choochoo::json::dump(next->value.value()) == R"({"b":2})");
+
+    // Broken within its line, so the rest of the line is skipped
+    auto broken = stream.next();
+    REQUIRE(broken);
+    REQUIRE(broken->value.error().code == choochoo::json::ErrorCode::EXPECTED_ARRAY_END);
+    REQUIRE(input.substr(broken->begin, broken->end - broken->begin) == "[1 2]\n");
+
+    REQUIRE(stream.next()->value.value().as_number() == 4.0);
+    REQUIRE_FALSE(stream.next());
+}
+
+TEST_CASE("An unterminated string spoils only its own line") {
+    const std::string input = "{\"a\": \"open\n{\"b\": 2}\n[\"tab\there\"]\n3\n";
+    for (size_t block_size : {size_t{0}, size_t{4}}) {
+        std::istringstream stream_input(input);
+        auto stream = block_size == 0 ? std::make_unique<choochoo::json::DocumentStream>(input)
+                                      : std::make_unique<choochoo::json::DocumentStream>(
+                                            stream_input, choochoo::json::ParseOptions{}, block_size);
+        INFO(block_size);
+        const auto documents = read_all(*stream, input);
+        REQUIRE(documents.size() == 4);
+        REQUIRE(documents[0] == std::pair<std::string, std::string>("error", "{\"a\": \"open\n"));
+        REQUIRE(documents[1].first == R"({"b":2})");
+        REQUIRE(documents[2] == std::pair<std::string, std::string>("error", "[\"tab\there\"]\n"));
+        REQUIRE(documents[3].first == "3");
+    }
+}
+
+TEST_CASE("Stream and file input give the same documents and ranges as a string") {
+    std::string input;
+    for (int i = 0; i < 200; ++i) {
+        input += R"({"id": )" + std::to_string(i) + R"(, "name": "item )" + std::to_string(i) + "\"}\n";
+        if (i % 50 == 0) {
+            input += "{\"broken\": tru}\n";
+        }
+    }
+    choochoo::json::DocumentStream from_string(input);
+    const auto expected = read_all(from_string, input);
+    REQUIRE(expected.size() == 204);
+
+    std::istringstream in(input);
+    choochoo::json::DocumentStream from_stream(in, {}, 16);
+    REQUIRE(read_all(from_stream, input) == expected);
+
+    const auto path = std::filesystem::temp_directory_path() / "choochoo_json_document_stream_test.jsonl";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << input;
+    }
+    auto file = choochoo::json::MappedFile::open(path.string());
+    REQUIRE(file);
+    choochoo::json::DocumentStream from_file(file.value(), {.zero_copy_strings = true});
+    REQUIRE(read_all(from_file, input) == expected);
+    std::remove(path.string().c_str());
+}
+
+TEST_CASE("A document stream recycles finished values") {
+    const std::string input = "[[1, 2], {\"a\": [3]}]\n[[4], {\"b\": []}]\n";
+    choochoo::json::DocumentStream stream(input);
+    std::vector<std::string> seen;
+    while (auto document = stream.next()) {
+        seen.push_back(choochoo::json::dump(document->value.value()));
+        stream.recycle(std::move(document->value.value()));
+    }
+    REQUIRE(seen == std::vector<std::string>{R"([[1,2],{"a":[3]}])", R"([[4],{"b":[]}])"});
+}
@@ -0,0 +1,157 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "choochoo/fused_parser.hpp"
+#include "choochoo/json.hpp"
+
+using choochoo::json::Type;
+using choochoo::json::Value;
+
+namespace {
+    // Compare numbers exactly, which pretty() does not, and keys by text since each parser interns its own
+    bool same_value(const Value& a, const Value& b) {
+        if (a.type() != b.type())
+            return false;
+        switch (a.type()) {
+        case Type::NULL_VALUE:
+            return true;
+        case Type::BOOLEAN:
+            return a.as_boolean() == b.as_boolean();
+        case Type::NUMBER:
+            return a.as_number() == b.as_number();
+        case Type::STRING:
+            return a.as_string().value() == b.as_string().value();
+        case Type::ARRAY: {
+            const auto& x = a.as_array()->get();
+            const auto& y = b.as_array()->get();
+            if (x.size() != y.size())
+                return false;
+            for (size_t i = 0; i < x.size(); ++i) {
+                if (!same_value(x[i], y[i]))
+                    return false;
+            }
+            return true;
+        }
+        case Type::OBJECT: {
+            const auto& x = a.as_object()->get();
+            const auto& y = b.as_object()->get();
+            if (x.size() != y.size())
+                return false;
+            for (const auto& [key, value] : x) {
+                bool found = false;
+                for (const auto& [other_key, other_value] : y) {
+                    if (*key == *other_key) {
+                        found = same_value(value, other_value);
+                        break;
+                    }
+                }
+                if (!found)
+                    return false;
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+} // namespace
+
+TEST_CASE("Fused parser produces the same Value as Parser") {
+    for (std::string json : {
+             std::string(R"({"name": "Alice", "age": 30, "active": true, "scores": [100, 99.5, -1e3]})"),
+             std::string(R"([null, false, "esc\"aped\n", {"nested": {"deep": [[], {}]}}, 0, -0.25])"),
+             std::string("  \n\t\"just a string\"  \r\n"),
+             std::string(R"({"dup": 1, "dup": 2})"),
+             std::string("{\n    \"pretty\": [\n        1,\n        2\n    ]\n}"),
+         }) {
+        INFO(json);
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer);
+        auto expected = parser.parse();
+        REQUIRE(expected);
+
+        choochoo::json::FusedParser<> fused(json);
+        auto result = fused.parse();
+        REQUIRE(result);
+        REQUIRE(same_value(result.value(), expected.value()));
+    }
+}
+
+TEST_CASE("Fused parser rejects what Parser rejects") {
+    for (std::string json : {"", "{name: \"Alice\"}", R"({"age": })", "[1, 2, 3,]", R"({"a": "\q"})", R"(["open)",
+                             "[truex]", "[1 2]", R"({"a" 1})", "[1] [2]", "[-]", "[1e400]"}) {
+        INFO(json);
+        choochoo::json::FusedParser<> fused(json);
+        REQUIRE_FALSE(fused.parse());
+    }
+}
+
+TEST_CASE("Fused parser reports line and column") {
+    std::string json = "{\n  \"a\": 1,\n  \"b\" 2\n}";
+    choochoo::json::FusedParser<std::string> fused(json);
+    auto result = fused.parse();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().message().find("line 3, column 7") != std::string::npos);
+}
+
+TEST_CASE("Fused parser enforces max_depth") {
+    const std::string json = std::string(50, '[') + std::string(50, ']');
+    REQUIRE(choochoo::json::FusedParser<>(json, {.max_depth = 50}).parse());
+    auto result = choochoo::json::FusedParser<>(json, {.max_depth = 49}).parse();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().code == choochoo::json::ErrorCode::DEPTH_EXCEEDED);
+    REQUIRE(result.error().message() == "Maximum nesting depth exceeded at line 1, column 50.");
+}
+
+TEST_CASE("Fused parser keeps deep nesting off the call stack") {
+    constexpr size_t DEPTH = 1000000;
+    std::string json;
+    for (size_t i = 0; i < DEPTH; ++i) {
+        json += i % 2 == 0 ? "[" : R"({"k":)";
+    }
+    json += "0";
+    for (size_t i = DEPTH; i-- > 0;) {
+        json += i % 2 == 0 ? "]" : "}";
+    }
+    choochoo::json::FusedParser<> parser(json, {.max_depth = SIZE_MAX});
+    auto result = parser.parse();
+    REQUIRE(result);
+    REQUIRE(choochoo::json::dump(result.value()) == json);
+}
+
+TEST_CASE("Fused parser borrows strings only from a string_view source") {
+    std::string json = R"(["a string without escapes"])";
+    choochoo::json::ParseOptions options{.zero_copy_strings = true};
+
+    auto borrowed = choochoo::json::FusedParser<>(json, options).parse();
+    REQUIRE(borrowed);
+    REQUIRE(borrowed->as_array()->get()[0].as_string()->data() == json.data() + 2);
+
+    // An owning source dies with the parser, so its strings are copied
+    auto copied = choochoo::json::FusedParser<std::string>(json, options).parse();
+    REQUIRE(copied);
+    REQUIRE(copied->as_array()->get()[0].as_string().value() == "a string without escapes");
+}
+
+// The parser points into its source, which would dangle in a copy or move of an owning source
+static_assert(!std::is_copy_constructible_v<choochoo::json::FusedParser<std::string>>);
+static_assert(!std::is_move_constructible_v<choochoo::json::FusedParser<std::string>>);
+static_assert(!std::is_move_assignable_v<choochoo::json::FusedParser<std::string>>);
+
+TEST_CASE("Fused parser reports the same error codes and locations as Parser") {
+    for (std::string_view json : {"", "[1,]", "[1, @]", R"(["abc)", "[nul]", "[1e999]", R"(["a\x"])", R"(["\ud800"])",
+                                  "{1: 2}", R"({"a" 1})", R"({"a": 1 "b": 2})", "[1,\n true 2]", "[1] 2",
+                                  "[1, \"a\nb\"]", "{\"a\\\x01\": 1}", R"({"ab)"}) {
+        INFO(json);
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer);
+        const auto expected = parser.parse();
+        const auto actual = choochoo::json::FusedParser<>(json).parse();
+        REQUIRE_FALSE(expected);
+        REQUIRE_FALSE(actual);
+        REQUIRE(actual.error().code == expected.error().code);
+        REQUIRE(actual.error().offset == expected.error().offset);
+        REQUIRE(actual.error().line == expected.error().line);
+        REQUIRE(actual.error().column == expected.error().column);
+    }
+}
@@ -1,26 +1,17 @@
 #include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <string>
-#include <unordered_map>
+#include <thread>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include "choochoo/json.hpp"
 
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            const std::string& key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
-
 TEST_CASE("Array iterator: range-based for and manual iteration") {
     using choochoo::json::Type;
     using choochoo::json::Value;
 
-    std::vector<Value> arr = {Value::number(1), Value::number(2), Value::number(3)};
+    choochoo::json::Array arr = {Value::number(1), Value::number(2), Value::number(3)};
     Value array_val = Value::array(arr);
 
     // Range-based for
@@ -54,11 +45,10 @@ TEST_CASE("Object iterator: range-based for and manual iteration") {
     using choochoo::json::Type;
     using choochoo::json::Value;
 
-    std::unordered_map<const std::string*, Value> obj;
-    std::unordered_set<std::string> key_pool;
+    choochoo::json::Object obj;
+    auto& key_table = *choochoo::json::KeyTable::global();
     for (const auto& k : {"a", "b", "c"}) {
-        auto [it, inserted] = key_pool.insert(std::string(k));
-        obj.emplace(&(*it), Value::number(k == std::string("a") ? 10 : k == std::string("b") ? 20 : 30));
+        obj.emplace(key_table.intern(k), Value::number(k == std::string("a") ? 10 : k == std::string("b") ? 20 : 30));
     }
     Value obj_val = Value::object(obj);
 
@@ -110,3 +100,147 @@ TEST_CASE("Iterator throws on wrong type") {
     REQUIRE_THROWS_AS(num_val.obj_begin(), std::logic_error);
     REQUIRE_THROWS_AS(str_val.obj_begin(), std::logic_error);
 }
+
+TEST_CASE("Object keeps insertion order and finds members of large objects") {
+    using choochoo::json::Object;
+    using choochoo::json::Value;
+
+    std::vector<choochoo::json::Key> names;
+    for (int i = 0; i < 100; ++i) {
+        names.emplace_back("key" + std::to_string(i));
+    }
+    // Insert in reverse so insertion order differs from any order the keys could sort in
+    Object obj;
+    for (size_t i = names.size(); i-- > 0;) {
+        auto [it, inserted] = obj.emplace(&names[i], Value::number(static_cast<double>(i)));
+        REQUIRE(inserted);
+        // Lookups work on both sides of the switch from linear search to the hash index
+        REQUIRE(obj.find(&names[i]) == it);
+        REQUIRE(obj.find(&names.back())->second.as_number() == 99);
+    }
+    REQUIRE(obj.size() == names.size());
+
+    size_t expected = names.size();
+    for (const auto& [key, value] : obj) {
+        REQUIRE(key == &names[--expected]);
+        REQUIRE(value.as_number() == static_cast<double>(expected));
+    }
+
+    // Pointer lookups only match the interned key itself, name lookups match the text
+    choochoo::json::Key other("key0");
+    REQUIRE(obj.find(&other) == obj.end());
+    REQUIRE_FALSE(obj.contains(&other));
+    REQUIRE_THROWS_AS(obj.at(&other), std::out_of_range);
+    REQUIRE(obj.find("key0") == obj.find(&names[0]));
+    REQUIRE(obj.at(&names[42]).as_number() == 42);
+    REQUIRE(obj.at("key42").as_number() == 42);
+    REQUIRE_FALSE(obj.contains("key100"));
+    REQUIRE_THROWS_AS(obj.at("key100"), std::out_of_range);
+
+    // A duplicate key keeps the first value
+    auto [it, inserted] = obj.emplace(&names[7], Value::boolean(true));
+    REQUIRE_FALSE(inserted);
+    REQUIRE(it->second.as_number() == 7);
+    REQUIRE(obj.size() == names.size());
+}
+
+TEST_CASE("Parsed objects print members in document order") {
+    std::string json = R"({"zebra": 1, "apple": {"y": true, "x": null}, "mango": [], "kiwi": "k"})";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE(result);
+    REQUIRE(result->pretty() == "{\n  \"zebra\": 1,\n  \"apple\": {\n    \"y\": true,\n    \"x\": null\n  },\n"
+                                "  \"mango\": [],\n  \"kiwi\": \"k\"\n}");
+}
+
+TEST_CASE("Value looks up object members by name") {
+    using choochoo::json::Type;
+
+    std::string json = R"({"user": {"name": "Alice", "tags": ["a"]}, "count": 3})";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE(result);
+    const auto& root = result.value();
+
+    REQUIRE(root.find("count") != nullptr);
+    REQUIRE(root.find("count")->as_number() == 3);
+    REQUIRE(root.find("missing") == nullptr);
+    REQUIRE(root.at("user").at("name").as_string().value() == "Alice");
+    REQUIRE_THROWS_AS(root.at("missing"), std::out_of_range);
+    REQUIRE_THROWS_AS(root.at("count").at("name"), std::logic_error);
+
+    // operator[] chains through missing members and non-objects as null
+    REQUIRE(root["user"]["tags"].type() == Type::ARRAY);
+    REQUIRE(root["user"]["missing"]["deeper"].type() == Type::NULL_VALUE);
+    REQUIRE(root["count"]["name"].type() == Type::NULL_VALUE);
+    REQUIRE(choochoo::json::Value::number(1).find("x") == nullptr);
+}
+
+TEST_CASE("Copies share containers until one of them is modified") {
+    using choochoo::json::Value;
+
+    std::string json = R"({"config": {"limits": [1, 2, 3]}, "name": "a name longer than inline storage"})";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE(result);
+    const Value& original = result.value();
+    const auto address_of = [](const Value& value, std::string_view name) {
+        return &value.at(name).as_object()->get();
+    };
+
+    Value copy = original;
+    REQUIRE(&std::as_const(copy).as_object()->get() == &original.as_object()->get());
+    REQUIRE(address_of(copy, "config") == address_of(original, "config"));
+
+    // Modifying the copy unshares only the containers on the way to the change
+    copy.at("name") = Value::number(42);
+    REQUIRE(&std::as_const(copy).as_object()->get() != &original.as_object()->get());
+    REQUIRE(address_of(copy, "config") == address_of(original, "config"));
+    REQUIRE(original["name"].as_string().value() == "a name longer than inline storage");
+
+    auto limit = choochoo::json::Path::dotted("config.limits[1]");
+    *limit->find(copy) = Value::number(20);
+    REQUIRE(limit->find(original)->as_number() == 2);
+    REQUIRE(limit->find(std::as_const(copy))->as_number() == 20);
+    REQUIRE(address_of(copy, "config") != address_of(original, "config"));
+}
+
+TEST_CASE("Copies of a shared tree can be made and modified on several threads") {
+    using choochoo::json::Value;
+
+    choochoo::json::Array items;
+    for (int i = 0; i < 100; ++i) {
+        items.push_back(Value::number(i));
+    }
+    choochoo::json::Object object;
+    object.emplace(choochoo::json::KeyTable::global()->intern("items"), Value::array(std::move(items)));
+    const Value shared = Value::object(std::move(object));
+
+    std::vector<std::thread> threads;
+    std::vector<double> sums(8);
+    for (size_t t = 0; t < sums.size(); ++t) {
+        threads.emplace_back([&shared, &sums, t] {
+            for (int round = 0; round < 100; ++round) {
+                Value copy = shared;
+                for (auto& item : copy.at("items")) {
+                    item = Value::number(item.as_number().value() + static_cast<double>(t));
+                }
+                double sum = 0;
+                for (const auto& item : std::as_const(copy).at("items")) {
+                    sum += item.as_number().value();
+                }
+                sums[t] = sum;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t t = 0; t < sums.size(); ++t) {
+        REQUIRE(sums[t] == 4950 + 100 * static_cast<double>(t));
+    }
+    REQUIRE(shared["items"].as_array()->get()[99].as_number() == 99);
+}
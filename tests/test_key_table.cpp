@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "choochoo/json.hpp"
+
+using choochoo::json::Key;
+using choochoo::json::KeyTable;
+
+TEST_CASE("Key table interns each text once") {
+    KeyTable table;
+    const Key* a = table.intern("alpha");
+    REQUIRE(*a == "alpha");
+    REQUIRE(a->hash() == Key::hash_of("alpha"));
+    REQUIRE(table.intern(std::string("alpha")) == a);
+    REQUIRE(table.find("alpha") == a);
+    REQUIRE(table.find("beta") == nullptr);
+    REQUIRE(table.intern("") != a);
+    REQUIRE(table.size() == 2);
+}
+
+TEST_CASE("Key table keeps key addresses across growth") {
+    KeyTable table;
+    std::vector<const Key*> keys;
+    for (int i = 0; i < 20000; ++i) {
+        keys.push_back(table.intern("key" + std::to_string(i)));
+    }
+    REQUIRE(table.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(table.find("key" + std::to_string(i)) == keys[i]);
+    }
+}
+
+TEST_CASE("Key table hands every thread the same keys") {
+    constexpr size_t THREADS = 8;
+    constexpr size_t KEYS = 5000;
+    KeyTable table;
+    std::vector<std::vector<const Key*>> seen(THREADS, std::vector<const Key*>(KEYS));
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            // Walk the keys from a different starting point in each thread so inserts race
+            for (size_t n = 0; n < KEYS; ++n) {
+                const size_t i = (n + t * KEYS / THREADS) % KEYS;
+                seen[t][i] = table.intern("k" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(table.size() == KEYS);
+    for (size_t t = 1; t < THREADS; ++t) {
+        REQUIRE(seen[t] == seen[0]);
+    }
+}
+
+TEST_CASE("Parsers opted in to the global table share its keys and trees outlive them") {
+    std::string json = R"({"shared": 1, "nested": {"shared": 2}})";
+    choochoo::json::Value first;
+    choochoo::json::Value second;
+    {
+        const choochoo::json::ParseOptions options{.key_table = KeyTable::global()};
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer, options);
+        first = parser.parse().value();
+        choochoo::json::FusedParser<> fused(json, options);
+        second = fused.parse().value();
+    }
+    const auto& members = first.as_object()->get();
+    REQUIRE(members.begin()->first == second.as_object()->get().begin()->first);
+    REQUIRE(members.begin()->first == KeyTable::global()->find("shared"));
+    REQUIRE(first["nested"]["shared"].as_number() == 2);
+}
+
+TEST_CASE("A private key table lives as long as the trees that need it") {
+    auto table = std::make_shared<KeyTable>();
+    std::weak_ptr<KeyTable> watch = table;
+
+    std::string json = R"({"private": true})";
+    choochoo::json::Lexer lexer(json);
+    auto parser = std::make_unique<choochoo::json::Parser>(lexer, choochoo::json::ParseOptions{nullptr, table});
+    auto result = parser->parse();
+    REQUIRE(result);
+    REQUIRE(table->find("private") != nullptr);
+    REQUIRE(KeyTable::global()->find("private") == nullptr);
+
+    choochoo::json::Document document(std::move(result.value()), parser->key_table());
+    table.reset();
+    parser.reset();
+    REQUIRE_FALSE(watch.expired());
+    REQUIRE(document.root()["private"].as_boolean() == true);
+}
+
+TEST_CASE("A parser's own key table is freed with the last tree using it") {
+    std::string json = R"({"ephemeral": {"nested": 1}})";
+    std::weak_ptr<KeyTable> watch;
+    choochoo::json::Value tree;
+    {
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer);
+        watch = parser.key_table();
+        tree = parser.parse().value();
+    }
+    REQUIRE(KeyTable::global()->find("ephemeral") == nullptr);
+    REQUIRE_FALSE(watch.expired());
+    choochoo::json::Value nested = tree["ephemeral"];
+    tree = choochoo::json::Value();
+    REQUIRE_FALSE(watch.expired());
+    REQUIRE(nested["nested"].as_number() == 1);
+    nested = choochoo::json::Value();
+    REQUIRE(watch.expired());
+}
+
+TEST_CASE("A parser starts a fresh key table once its own is full") {
+    std::string json = "{";
+    for (size_t i = 0; i < choochoo::json::PRIVATE_KEY_TABLE_LIMIT; ++i) {
+        json += (i == 0 ? "\"k" : ",\"k") + std::to_string(i) + "\":0";
+    }
+    json += "}";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto first = parser.parse().value();
+    const auto full = parser.key_table();
+    REQUIRE(full->size() == choochoo::json::PRIVATE_KEY_TABLE_LIMIT);
+
+    std::string next = R"({"k0": 1})";
+    lexer.reset(next);
+    parser.reset();
+    REQUIRE(parser.key_table() != full);
+    auto second = parser.parse().value();
+    REQUIRE(second.as_object()->get().begin()->first->table() == parser.key_table().get());
+    REQUIRE(first["k0"].as_number() == 0);
+    REQUIRE(second["k0"].as_number() == 1);
+}
+
+TEST_CASE("Objects keep every key in one table") {
+    auto first = std::make_shared<KeyTable>();
+    auto second = std::make_shared<KeyTable>();
+    std::weak_ptr<KeyTable> watch = first;
+
+    choochoo::json::Object object;
+    const Key own("own");
+    object.emplace(&own, choochoo::json::Value::number(0));
+    object.emplace(first->intern("a"), choochoo::json::Value::number(1));
+    REQUIRE(first->find("own") != nullptr);
+    REQUIRE_FALSE(object.emplace(second->intern("a"), choochoo::json::Value::number(2)).second);
+    object.emplace(second->intern("b"), choochoo::json::Value::number(3));
+    for (const auto& [key, value] : object) {
+        REQUIRE(key->table() == first.get());
+    }
+    REQUIRE(object.find(second->intern("b"))->second.as_number() == 3);
+    REQUIRE(object.find(&own)->second.as_number() == 0);
+
+    first.reset();
+    REQUIRE_FALSE(watch.expired());
+    object.clear();
+    REQUIRE(watch.expired());
+}
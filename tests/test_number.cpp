@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "choochoo/json.hpp"
+
+using choochoo::json::number::parse_double;
+using choochoo::json::number::parse_int64;
+
+TEST_CASE("parse_double converts valid JSON numbers") {
+    REQUIRE(parse_double("0") == 0.0);
+    REQUIRE(std::signbit(*parse_double("-0")));
+    REQUIRE(parse_double("42") == 42.0);
+    REQUIRE(parse_double("-17") == -17.0);
+    REQUIRE(parse_double("3.25") == 3.25);
+    REQUIRE(parse_double("1e3") == 1000.0);
+    REQUIRE(parse_double("1E+3") == 1000.0);
+    REQUIRE(parse_double("25e-2") == 0.25);
+    REQUIRE(parse_double("0.1") == 0.1);
+    REQUIRE(parse_double("-122.419416") == -122.419416);
+    REQUIRE(parse_double("1.7976931348623157e308") == 1.7976931348623157e308);
+    REQUIRE(parse_double("4.9406564584124654e-324") == 4.9406564584124654e-324);
+    REQUIRE(parse_double("123456789012345678901234567890") == 123456789012345678901234567890.0);
+}
+
+TEST_CASE("parse_double rejects malformed and out of range numbers") {
+    for (const char* text : {"", "-", "+1", "01", "1.", ".5", "1e", "1e+", "0x10", "1 ", " 1", "NaN", "Infinity",
+                             "1.5.5", "--1", "1e400", "-1e400"}) {
+        INFO(text);
+        REQUIRE_FALSE(parse_double(text));
+    }
+}
+
+TEST_CASE("parse_double rounds magnitudes below the double range like strtod") {
+    REQUIRE(parse_double("1e-400") == 0.0);
+    REQUIRE_FALSE(std::signbit(*parse_double("1e-400")));
+    REQUIRE(std::signbit(*parse_double("-1e-400")));
+    REQUIRE(parse_double("0.000001e-99999999") == 0.0);
+    REQUIRE(parse_double("123456789012345678901234567890e-360") == 0.0);
+    REQUIRE(parse_double("2.4703282292062327e-324") == 0.0);
+    REQUIRE(parse_double("2.4703282292062328e-324") == 4.9406564584124654e-324);
+    REQUIRE(parse_double("-3e-324") == -4.9406564584124654e-324);
+}
+
+TEST_CASE("parse_double matches strtod on random inputs") {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::uniform_int_distribution<int> length(1, 24);
+    std::uniform_int_distribution<int> exponent(-330, 310);
+
+    for (int i = 0; i < 20000; ++i) {
+        std::string digits = std::to_string(digit(rng) % 9 + 1);
+        for (int n = length(rng); n > 0; --n) {
+            digits += static_cast<char>('0' + digit(rng));
+        }
+        if (rng() & 1) {
+            digits.insert(1 + rng() % digits.size(), ".");
+            if (digits.back() == '.')
+                digits += '5';
+        }
+        std::string text = ((rng() & 1) ? "-" : "") + digits;
+        if (rng() & 1) {
+            text += "e" + std::to_string(exponent(rng));
+        }
+
+        const double expected = std::strtod(text.c_str(), nullptr);
+        auto parsed = parse_double(text);
+        INFO(text);
+        if (std::isinf(expected)) {
+            REQUIRE_FALSE(parsed);
+            continue;
+        }
+        REQUIRE(parsed);
+        REQUIRE(*parsed == expected);
+        REQUIRE(std::signbit(*parsed) == std::signbit(expected));
+    }
+}
+
+TEST_CASE("parse_int64 covers the full range and rejects everything else") {
+    REQUIRE(parse_int64("0") == 0);
+    REQUIRE(parse_int64("-42") == -42);
+    REQUIRE(parse_int64("9223372036854775807") == INT64_MAX);
+    REQUIRE(parse_int64("-9223372036854775808") == INT64_MIN);
+    REQUIRE_FALSE(parse_int64("9223372036854775808"));
+    REQUIRE_FALSE(parse_int64("-9223372036854775809"));
+    REQUIRE_FALSE(parse_int64("1.0"));
+    REQUIRE_FALSE(parse_int64("1e2"));
+    REQUIRE_FALSE(parse_int64("007"));
+    REQUIRE_FALSE(parse_int64("-"));
+    REQUIRE_FALSE(parse_int64(""));
+}
+
+TEST_CASE("Parser reports numbers out of double range") {
+    std::string json = R"({"big": 1e999})";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().message().find("Invalid number format") != std::string::npos);
+}
+
+TEST_CASE("Parser reads numbers below double range as zero") {
+    std::string json = R"({"tiny": 1e-400, "negative": -1e-400})";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE(result);
+    REQUIRE((*result)["tiny"].as_number() == 0.0);
+    REQUIRE(std::signbit(*(*result)["negative"].as_number()));
+}
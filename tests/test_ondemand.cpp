@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+#include "choochoo/json.hpp"
+
+using choochoo::json::ondemand::Document;
+
+TEST_CASE("On-demand lookups read nested fields") {
+    std::string json = R"({"user": {"id": 42, "name": "Alice", "admin": false, "tags": ["a", "b"]}, "score": 9.5})";
+    Document document(json);
+
+    REQUIRE(document.find_field("user")["id"].get_int64() == 42);
+    REQUIRE(document["user"]["name"].get_string() == "Alice");
+    REQUIRE(document["user"]["admin"].get_bool() == false);
+    REQUIRE(document["user"]["tags"].at(1).get_string() == "b");
+    REQUIRE(document["score"].get_double() == 9.5);
+    REQUIRE(document["user"].type() == choochoo::json::Type::OBJECT);
+}
+
+TEST_CASE("On-demand errors surface at the end of the chain") {
+    std::string json = "{\n  \"user\": {\"id\": \"not a number\"}\n}";
+    Document document(json);
+
+    auto missing = document["user"]["missing"]["deeper"].get_int64();
+    REQUIRE_FALSE(missing);
+    REQUIRE(missing.error().code == choochoo::json::ErrorCode::NO_SUCH_FIELD);
+
+    auto wrong_type = document["user"]["id"].get_int64();
+    REQUIRE_FALSE(wrong_type);
+    REQUIRE(wrong_type.error().message() == "Expected a 64-bit integer at line 2, column 18.");
+
+    REQUIRE_FALSE(document["user"].at(0).valid());
+    REQUIRE(document["user"].at(0).error()->code == choochoo::json::ErrorCode::EXPECTED_ARRAY);
+    REQUIRE_FALSE(document["user"].error());
+    REQUIRE_FALSE(Document("   ").root().type());
+}
+
+TEST_CASE("On-demand object lookups wrap around") {
+    std::string json = R"({"a": 1, "b": {"skip": [1, {"}": "]"}]}, "c": 3})";
+    auto object = Document(json).root().get_object();
+    REQUIRE(object.valid());
+
+    REQUIRE(object["c"].get_int64() == 3);
+    REQUIRE(object["a"].get_int64() == 1);
+    REQUIRE(object["c"].get_int64() == 3);
+    REQUIRE(object["b"]["skip"].at(1)["}"].get_string() == "]");
+    REQUIRE_FALSE(object["d"].valid());
+}
+
+TEST_CASE("On-demand iteration skips unread values") {
+    std::string json = R"({"first": [1, [2, 3], {"x": "y"}], "escaped\"key": "v", "last": null})";
+    Document document(json);
+
+    std::vector<std::string> keys;
+    for (const auto& field : document.root().get_object()) {
+        REQUIRE(field.value.valid());
+        keys.push_back(field.unescaped_key().value());
+    }
+    REQUIRE(keys == std::vector<std::string>{"first", "escaped\"key", "last"});
+
+    std::vector<std::string> elements;
+    for (auto element : document["first"].get_array()) {
+        elements.push_back(std::string(element.raw_json().value()));
+    }
+    REQUIRE(elements == std::vector<std::string>{"1", "[2, 3]", R"({"x": "y"})"});
+    REQUIRE(document["first"].get_array().count() == 3);
+    REQUIRE(document["escaped\"key"].get_string() == "v");
+    REQUIRE(document["last"].is_null() == true);
+
+    size_t empty = 0;
+    for ([[maybe_unused]] auto element : Document("[ ]").root().get_array()) {
+        ++empty;
+    }
+    REQUIRE(empty == 0);
+}
+
+TEST_CASE("On-demand iteration stops at malformed input") {
+    std::vector<bool> valid;
+    for (auto element : Document("[1, 2 3]").root().get_array()) {
+        valid.push_back(element.valid());
+    }
+    REQUIRE(valid == std::vector<bool>{true, true, false});
+
+    valid.clear();
+    for (const auto& field : Document(R"({"a": 1, "b" 2})").root().get_object()) {
+        valid.push_back(field.value.valid());
+    }
+    REQUIRE(valid == std::vector<bool>{true, false});
+
+    REQUIRE_FALSE(Document("[1, [2, 3]").root().get_array().count());
+}
+
+TEST_CASE("On-demand values materialize into a tree") {
+    std::string json = R"({"skipped": [1, 2, 3], "kept": {"name": "Alice", "list": [true, null]}})";
+    auto kept = Document(json)["kept"].materialize();
+    REQUIRE(kept);
+    REQUIRE(kept->pretty() == R"({
+  "name": "Alice",
+  "list": [
+    true,
+    null
+  ]
+})");
+}
+
+TEST_CASE("On-demand errors are located in the whole document") {
+    std::string json = "{\"ok\": 1,\n \"bad\": [1, \"\\x\"], \"key\\q\": 2, \"raw\": \"a\tb\"}";
+    Document document(json);
+
+    // Lookups skip the raw control character too, so reach it by iterating
+    for (const auto& field : document.root().get_object()) {
+        if (field.key == "raw") {
+            auto raw = field.value.get_raw_string();
+            REQUIRE_FALSE(raw);
+            REQUIRE(raw.error().code == choochoo::json::ErrorCode::CONTROL_CHARACTER);
+            REQUIRE(raw.error().offset == json.find('\t'));
+        }
+    }
+    REQUIRE(document["raw"].error()->code == choochoo::json::ErrorCode::MALFORMED_VALUE);
+
+    auto bad = document["bad"].materialize();
+    REQUIRE_FALSE(bad);
+    REQUIRE(bad.error().code == choochoo::json::ErrorCode::INVALID_ESCAPE);
+    REQUIRE(bad.error().line == 2);
+    REQUIRE(bad.error().offset == json.find("\\x"));
+
+    for (const auto& field : document.root().get_object()) {
+        if (field.key == "key\\q") {
+            auto key = field.unescaped_key();
+            REQUIRE_FALSE(key);
+            REQUIRE(key.error().offset == json.find("\\q"));
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include "choochoo/json.hpp"
+
+namespace {
+    /// Counts the allocations passed on to the default resource.
+    struct CountingResource : std::pmr::memory_resource {
+        size_t allocations{0};
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+} // namespace
+
+TEST_CASE("A parse context parses one document after another") {
+    choochoo::json::ParseContext context;
+    auto first = context.parse(R"({"a": [1, 2, {"b": true}]})");
+    REQUIRE(first);
+    REQUIRE(choochoo::json::dump(first.value()) == R"({"a":[1,2,{"b":true}]})");
+
+    // A failure part way through a container leaves nothing behind for the next document
+    auto broken = context.parse(R"({"a": [1, 2, {"b": )");
+    REQUIRE_FALSE(broken);
+    REQUIRE(broken.error().code == choochoo::json::ErrorCode::UNEXPECTED_EOF);
+
+    auto second = context.parse(R"([null, "x"])");
+    REQUIRE(second);
+    REQUIRE(choochoo::json::dump(second.value()) == R"([null,"x"])");
+    REQUIRE_FALSE(context.parse("[1] 2"));
+    REQUIRE(context.parse("3").value().as_number() == 3.0);
+}
+
+TEST_CASE("parse_into refills the containers of the previous result") {
+    std::string json = R"({"rows": [)";
+    for (int i = 0; i < 40; ++i) {
+        json += (i == 0 ? "" : ",") + std::string(R"({"id": )") + std::to_string(i) + R"(, "tags": [1, 2, 3]})";
+    }
+    json += "]}";
+
+    CountingResource resource;
+    choochoo::json::ParseContext context({.memory_resource = &resource});
+    choochoo::json::Value document;
+    REQUIRE(context.parse_into(json, document));
+    const size_t first_allocations = resource.allocations;
+
+    resource.allocations = 0;
+    REQUIRE(context.parse_into(json, document));
+    REQUIRE(resource.allocations < first_allocations);
+    choochoo::json::ParseContext fresh;
+    REQUIRE(choochoo::json::dump(document) == choochoo::json::dump(fresh.parse(json).value()));
+
+    // On failure the previous result is recycled all the same
+    REQUIRE_FALSE(context.parse_into("[1, ", document));
+    REQUIRE(document.type() == choochoo::json::Type::NULL_VALUE);
+}
+
+TEST_CASE("Recycling leaves shared containers to their other owners") {
+    choochoo::json::ParseContext context;
+    choochoo::json::Value document;
+    REQUIRE(context.parse_into(R"({"list": [1, 2, 3], "inner": {"k": "v"}})", document));
+    const choochoo::json::Value copy = document;
+    const choochoo::json::Value list = document["list"];
+
+    REQUIRE(context.parse_into(R"([true])", document));
+    REQUIRE(choochoo::json::dump(copy) == R"({"list":[1,2,3],"inner":{"k":"v"}})");
+    REQUIRE(choochoo::json::dump(list) == "[1,2,3]");
+    REQUIRE(choochoo::json::dump(document) == "[true]");
+}
+
+TEST_CASE("A lexer can be reset from a stream to a string") {
+    std::istringstream stream(R"({"a": 1})");
+    choochoo::json::Lexer lexer(stream, 4);
+    choochoo::json::Parser parser(lexer);
+    REQUIRE(parser.parse());
+
+    lexer.reset("[1,\n 2]");
+    parser.reset();
+    auto result = parser.parse();
+    REQUIRE(result);
+    REQUIRE(choochoo::json::dump(result.value()) == "[1,2]");
+
+    lexer.reset("[1,\n x]");
+    parser.reset();
+    auto failed = parser.parse();
+    REQUIRE_FALSE(failed);
+    REQUIRE(failed.error().line == 2);
+    REQUIRE(failed.error().column == 2);
+}
@@ -1,4 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <sstream>
 #include "choochoo/json.hpp"
 
 TEST_CASE("Valid JSON parses successfully") {
@@ -73,3 +76,244 @@ TEST_CASE("Bad string escape fails") {
     auto bad_result = bad_parser.parse();
     REQUIRE_FALSE(bad_result);
 }
+
+TEST_CASE("Long strings with and without escapes decode correctly") {
+    std::string plain(100, 'a');
+    std::string json = R"([")" + plain + R"(", ")" + plain + R"(\"\\\/\b\f\n\r\t)" + plain + R"("])";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE(result);
+    const auto& arr = result.value().as_array()->get();
+    REQUIRE(arr.size() == 2);
+    REQUIRE(arr[0].as_string().value() == plain);
+    REQUIRE(arr[1].as_string().value() == plain + "\"\\/\b\f\n\r\t" + plain);
+}
+
+TEST_CASE("Unterminated long string fails") {
+    std::string json = R"([")" + std::string(100, 'a') + R"(\")";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    REQUIRE_FALSE(parser.parse());
+}
+
+TEST_CASE("Errors in indented input report line and column") {
+    std::string json = "{\n" + std::string(40, ' ') + "\"a\": 1,\n\t\t\t\t\"b\": ,\n}";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().line == 3);
+    REQUIRE(result.error().column == 10);
+    REQUIRE(result.error().message().find("line 3, column 10") != std::string::npos);
+}
+
+TEST_CASE("Vertical tab is not JSON whitespace") {
+    std::string json = "[1,\v2]";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    REQUIRE_FALSE(parser.parse());
+}
+
+TEST_CASE("Parsed tree allocates only from the given memory resource") {
+    std::string json = R"({"name": "Alice", "tags": ["a", "b\"c", "a string too long for the small string buffer"],
+                           "meta": {"n": 1, "list": [[], {}]}})";
+    std::pmr::monotonic_buffer_resource arena;
+
+    // Any container falling back to the default resource would throw std::bad_alloc
+    struct DefaultResourceGuard {
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        ~DefaultResourceGuard() { std::pmr::set_default_resource(previous); }
+    };
+    choochoo::json::Lexer lexer(json);
+    std::optional<choochoo::json::Parser> parser;
+    std::expected<choochoo::json::Value, choochoo::json::Error> result;
+    {
+        DefaultResourceGuard guard;
+        parser.emplace(lexer, choochoo::json::ParseOptions{&arena});
+        result = parser->parse();
+    }
+    REQUIRE(result);
+    REQUIRE(result->as_object()->get().get_allocator().resource() == &arena);
+
+    // A copy leaves the arena behind
+    choochoo::json::Value copy = result.value();
+    REQUIRE(copy.as_object()->get().get_allocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(copy.pretty() == result->pretty());
+}
+
+TEST_CASE("Zero-copy strings view the input and only escaped strings are copied") {
+    std::string json = R"(["a string without escapes", "tab\tseparated", {"key": "another long string"}])";
+    const auto in_input = [&](std::string_view s) {
+        return s.data() >= json.data() && s.data() < json.data() + json.size();
+    };
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer, choochoo::json::ParseOptions{.zero_copy_strings = true});
+    auto result = parser.parse();
+    REQUIRE(result);
+    const auto& arr = result->as_array()->get();
+    REQUIRE(arr[0].as_string().value() == "a string without escapes");
+    REQUIRE(in_input(arr[0].as_string().value()));
+    REQUIRE(arr[1].as_string().value() == "tab\tseparated");
+    REQUIRE_FALSE(in_input(arr[1].as_string().value()));
+    REQUIRE(in_input(arr[2]["key"].as_string().value()));
+
+    // Copies own their text, so they outlive the input
+    choochoo::json::Value copy = result.value();
+    json.assign(json.size(), 'x');
+    const auto& copied = copy.as_array()->get();
+    REQUIRE(copied[0].as_string().value() == "a string without escapes");
+    REQUIRE(copied[2]["key"].as_string().value() == "another long string");
+}
+
+TEST_CASE("Zero-copy strings are ignored for stream input") {
+    std::istringstream input(R"(["a string spanning more than one stream block"])");
+    choochoo::json::Lexer lexer(input, 8);
+    choochoo::json::Parser parser(lexer, choochoo::json::ParseOptions{.zero_copy_strings = true});
+    auto result = parser.parse();
+    REQUIRE(result);
+    REQUIRE(result->as_array()->get()[0].as_string().value() == "a string spanning more than one stream block");
+}
+
+TEST_CASE("Short strings are stored inline") {
+    std::string text = "short";
+    choochoo::json::Value value = choochoo::json::Value::string(text, std::pmr::get_default_resource());
+    const auto view = value.as_string().value();
+    REQUIRE(view == "short");
+    // Inline text lives in the value itself
+    REQUIRE(view.data() >= reinterpret_cast<const char*>(&value));
+    REQUIRE(view.data() < reinterpret_cast<const char*>(&value) + sizeof(value));
+}
+
+TEST_CASE("Unicode escapes decode to UTF-8") {
+    auto decoded = choochoo::json::unescape(R"(A\u00e9\u20AC\ud83d\ude00\u0000)");
+    REQUIRE(decoded);
+    REQUIRE(decoded.value() == std::string("A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", 10) + '\0');
+
+    REQUIRE_FALSE(choochoo::json::unescape(R"(\u12)"));
+    REQUIRE_FALSE(choochoo::json::unescape(R"(\u12g4)"));
+    REQUIRE_FALSE(choochoo::json::unescape(R"(\ud83d)"));
+    REQUIRE_FALSE(choochoo::json::unescape(R"(\ud83dA)"));
+    REQUIRE_FALSE(choochoo::json::unescape(R"(\ude00)"));
+}
+
+TEST_CASE("Deep nesting parses, prints, copies and tears down without recursion") {
+    const size_t depth = 200000;
+    std::string json;
+    for (size_t i = 0; i < depth; ++i) {
+        json += i % 2 == 0 ? R"({"a":)" : "[";
+    }
+    json += "null";
+    for (size_t i = depth; i-- > 0;) {
+        json += i % 2 == 0 ? "}" : "]";
+    }
+
+    std::pmr::monotonic_buffer_resource arena;
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer, {.memory_resource = &arena, .max_depth = depth});
+    auto result = parser.parse();
+    REQUIRE(result);
+    REQUIRE(choochoo::json::dump(result.value()) == json);
+
+    // The tree lives in an arena, so copying it copies every level
+    choochoo::json::Value copy = result.value();
+    REQUIRE(choochoo::json::dump(copy) == json);
+    result = choochoo::json::Value::null();
+    REQUIRE(copy["a"].type() == choochoo::json::Type::ARRAY);
+
+    // A copy in the default resource shares its containers; destroying the last owner frees them all
+    choochoo::json::Value shared = copy;
+    copy = choochoo::json::Value::null();
+    REQUIRE(choochoo::json::dump(shared) == json);
+}
+
+TEST_CASE("Copying a deep tree after non-const traversal does not recurse") {
+    // Non-const access forgets whether each container on the way holds borrowed strings, so the copy has to find
+    // out again for every level
+    const size_t depth = 1000000;
+    const std::string json = std::string(depth, '[') + std::string(depth, ']');
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer, {.max_depth = SIZE_MAX});
+    auto result = parser.parse();
+    REQUIRE(result);
+
+    const auto innermost = [](choochoo::json::Value& root) {
+        choochoo::json::Value* value = &root;
+        while (value->begin() != value->end()) {
+            value = &*value->begin();
+        }
+        return value;
+    };
+    innermost(result.value());
+    choochoo::json::Value shared = result.value();
+    REQUIRE(choochoo::json::dump(shared) == json);
+
+    // A borrowed string at the bottom makes every level borrow, so this copy is a deep one
+    *innermost(result.value()) = choochoo::json::Value::borrowed_string("leaf");
+    choochoo::json::Value copy = result.value();
+    result = choochoo::json::Value::null();
+    REQUIRE(choochoo::json::dump(copy).size() == json.size() + 4);
+}
+
+TEST_CASE("Nesting beyond max_depth fails cleanly") {
+    const std::string too_deep = std::string(choochoo::json::DEFAULT_MAX_DEPTH + 1, '[') +
+                                 std::string(choochoo::json::DEFAULT_MAX_DEPTH + 1, ']');
+    choochoo::json::Lexer lexer(too_deep);
+    choochoo::json::Parser parser(lexer);
+    auto result = parser.parse();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().message() == "Maximum nesting depth exceeded at line 1, column 1025.");
+
+    std::string json = R"({"list": [[1], {"k": []}]})";
+    choochoo::json::Lexer shallow_lexer(json);
+    choochoo::json::Parser shallow(shallow_lexer, {.max_depth = 4});
+    REQUIRE(shallow.parse());
+    choochoo::json::Lexer deeper_lexer(json);
+    choochoo::json::Parser deeper(deeper_lexer, {.max_depth = 3});
+    REQUIRE_FALSE(deeper.parse());
+}
+
+TEST_CASE("Parse errors carry a code and the location they were found at") {
+    using choochoo::json::ErrorCode;
+    const auto error_of = [](std::string_view json) {
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer);
+        auto result = parser.parse();
+        REQUIRE_FALSE(result);
+        return result.error();
+    };
+    REQUIRE(error_of("").code == ErrorCode::UNEXPECTED_EOF);
+    REQUIRE(error_of("[1,]").code == ErrorCode::UNEXPECTED_TOKEN);
+    REQUIRE(error_of("[1, @]").code == ErrorCode::UNEXPECTED_CHARACTER);
+    REQUIRE(error_of(R"(["abc)").code == ErrorCode::UNTERMINATED_STRING);
+    REQUIRE(error_of("[\"a\tb\"]").code == ErrorCode::CONTROL_CHARACTER);
+    REQUIRE(error_of("[\"a\\\nb\"]").code == ErrorCode::CONTROL_CHARACTER);
+    REQUIRE(error_of("[nul]").code == ErrorCode::INVALID_LITERAL);
+    REQUIRE(error_of("[1e999]").code == ErrorCode::INVALID_NUMBER);
+    REQUIRE(error_of(R"(["\x"])").code == ErrorCode::INVALID_ESCAPE);
+    REQUIRE(error_of(R"(["\ud800"])").code == ErrorCode::INVALID_UNICODE_ESCAPE);
+    REQUIRE(error_of("{1: 2}").code == ErrorCode::EXPECTED_KEY);
+    REQUIRE(error_of(R"({"a" 1})").code == ErrorCode::EXPECTED_COLON);
+    REQUIRE(error_of(R"({"a": 1 "b": 2})").code == ErrorCode::EXPECTED_OBJECT_END);
+    REQUIRE(error_of("[1 2]").code == ErrorCode::EXPECTED_ARRAY_END);
+    REQUIRE(error_of("[1] 2").code == ErrorCode::TRAILING_CONTENT);
+
+    const auto error = error_of("[1,\n true 2]");
+    REQUIRE(error.code == ErrorCode::EXPECTED_ARRAY_END);
+    REQUIRE(error.token == choochoo::json::token::Type::NUMBER);
+    REQUIRE(error.offset == 10);
+    REQUIRE(error.line == 2);
+    REQUIRE(error.column == 7);
+    REQUIRE(error.message() == "Expected ',' or ']' in array, but found NUMBER at line 2, column 7.");
+
+    // Escape errors point into the string
+    const auto escape = error_of(R"(["ab\q"])");
+    REQUIRE(escape.offset == 4);
+    REQUIRE(escape.column == 5);
+
+    // unescape() alone knows only the offset within the raw string
+    const auto raw = choochoo::json::unescape(R"(ab\q)");
+    REQUIRE_FALSE(raw);
+    REQUIRE(raw.error().offset == 2);
+    REQUIRE(raw.error().message() == "Invalid escape sequence.");
+}
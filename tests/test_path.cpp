@@ -0,0 +1,102 @@
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <string>
+#include "choochoo/json.hpp"
+
+using choochoo::json::ErrorCode;
+using choochoo::json::Path;
+
+namespace {
+    choochoo::json::Value parse(const std::string& json, choochoo::json::ParseOptions options = {}) {
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer, std::move(options));
+        auto result = parser.parse();
+        REQUIRE(result);
+        return std::move(result.value());
+    }
+} // namespace
+
+TEST_CASE("JSON Pointer follows RFC 6901 examples") {
+    auto doc = parse(R"({"foo": ["bar", "baz"], "": 0, "a/b": 1, "c%d": 2, "e^f": 3, "g|h": 4, "i\\j": 5,
+                         "k\"l": 6, " ": 7, "m~n": 8})");
+    const auto number_at = [&](std::string_view pointer) {
+        auto path = Path::pointer(pointer);
+        REQUIRE(path);
+        const auto* value = path->find(doc);
+        REQUIRE(value != nullptr);
+        return value->as_number().value();
+    };
+
+    REQUIRE(Path::pointer("")->find(doc) == &doc);
+    REQUIRE(Path::pointer("/foo/0")->find(doc)->as_string() == "bar");
+    REQUIRE(number_at("/") == 0);
+    REQUIRE(number_at("/a~1b") == 1);
+    REQUIRE(number_at("/c%d") == 2);
+    REQUIRE(number_at("/e^f") == 3);
+    REQUIRE(number_at("/g|h") == 4);
+    REQUIRE(number_at("/i\\j") == 5);
+    REQUIRE(number_at("/k\"l") == 6);
+    REQUIRE(number_at("/ ") == 7);
+    REQUIRE(number_at("/m~0n") == 8);
+}
+
+TEST_CASE("JSON Pointer misses and malformed pointers") {
+    auto doc = parse(R"({"list": [1, 2], "obj": {"0": "zero"}})");
+
+    REQUIRE(Path::pointer("/obj/0")->find(doc)->as_string() == "zero");
+    REQUIRE(Path::pointer("/list/2")->find(doc) == nullptr);
+    REQUIRE(Path::pointer("/list/-")->find(doc) == nullptr);
+    REQUIRE(Path::pointer("/list/01")->find(doc) == nullptr);
+    REQUIRE(Path::pointer("/missing/x")->find(doc) == nullptr);
+    REQUIRE(Path::pointer("/list/0/deeper")->find(doc) == nullptr);
+
+    REQUIRE(Path::pointer("list").error().code == ErrorCode::POINTER_WITHOUT_SLASH);
+    REQUIRE(Path::pointer("/a~2").error().code == ErrorCode::INVALID_POINTER_ESCAPE);
+    REQUIRE(Path::pointer("/a~").error().offset == 2);
+}
+
+TEST_CASE("Dotted paths with indices") {
+    auto doc = parse(R"({"user": {"tags": ["a", {"name": "b"}], "id": 7}, "rows": [[1, 2], [3, 4]]})");
+
+    auto path = Path::dotted("user.tags[1].name");
+    REQUIRE(path);
+    REQUIRE(path->size() == 4);
+    REQUIRE(path->find(doc)->as_string() == "b");
+    REQUIRE(Path::dotted("user.id")->find(doc)->as_number() == 7);
+    REQUIRE(Path::dotted("rows[1][0]")->find(doc)->as_number() == 3);
+    REQUIRE(Path::dotted("user.tags.0")->find(doc)->as_string() == "a");
+    REQUIRE(Path::dotted("")->find(doc) == &doc);
+    REQUIRE(Path::dotted("[0]")->find(doc) == nullptr);
+    REQUIRE(Path::dotted("user[0]")->find(doc) == nullptr);
+
+    auto rows = doc.at("rows");
+    REQUIRE(Path::dotted("[1][1]")->find(rows)->as_number() == 4);
+
+    REQUIRE(Path::dotted("user..id").error().code == ErrorCode::EMPTY_PATH_NAME);
+    REQUIRE(Path::dotted("user.").error().code == ErrorCode::EMPTY_PATH_NAME);
+    REQUIRE(Path::dotted(".user").error().code == ErrorCode::EMPTY_PATH_NAME);
+    REQUIRE(Path::dotted("rows[1").error().code == ErrorCode::UNTERMINATED_PATH_INDEX);
+    REQUIRE(Path::dotted("rows[x]").error().code == ErrorCode::INVALID_PATH_INDEX);
+    REQUIRE(Path::dotted("rows[1]x").error().message() == "Expected '.' or '[' in path at position 7.");
+}
+
+TEST_CASE("Compiled paths are reused across documents and can modify them") {
+    auto path = Path::dotted("config.limit");
+    REQUIRE(path);
+    for (int limit : {1, 2, 3}) {
+        auto doc = parse(R"({"config": {"limit": )" + std::to_string(limit) + "}}");
+        REQUIRE(path->find(doc)->as_number() == limit);
+        *path->find(doc) = choochoo::json::Value::number(limit * 10);
+        REQUIRE(doc["config"]["limit"].as_number() == limit * 10);
+    }
+}
+
+TEST_CASE("Paths match keys from any table and keep their tokens out of the global one") {
+    auto private_table = std::make_shared<choochoo::json::KeyTable>();
+    auto doc = parse(R"({"key": {"path token only": true}})", choochoo::json::ParseOptions{.key_table = private_table});
+
+    REQUIRE(Path::pointer("/key/path token only", private_table)->find(doc)->as_boolean() == true);
+    REQUIRE(Path::dotted("key.path token only")->find(doc)->as_boolean() == true);
+    REQUIRE(Path::pointer("/key/missing")->find(doc) == nullptr);
+    REQUIRE(choochoo::json::KeyTable::global()->find("path token only") == nullptr);
+}
@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "choochoo/json.hpp"
+
+namespace {
+    /// Records every event as a short string.
+    struct Recorder {
+        std::vector<std::string> events;
+
+        bool on_null() { return add("null"); }
+        bool on_bool(bool value) { return add(value ? "true" : "false"); }
+        bool on_number(double value) { return add("n:" + std::to_string(static_cast<long long>(value))); }
+        bool on_string(std::string_view text) { return add("s:" + std::string(text)); }
+        bool on_key(std::string_view text) { return add("k:" + std::string(text)); }
+        bool on_start_object() { return add("{"); }
+        bool on_end_object() { return add("}"); }
+        bool on_start_array() { return add("["); }
+        bool on_end_array() { return add("]"); }
+
+        bool add(std::string event) {
+            events.push_back(std::move(event));
+            return true;
+        }
+    };
+
+    /// Counts the numbers under a given key and stops at the first "stop" key.
+    struct Counter : choochoo::json::sax::BaseHandler {
+        size_t numbers = 0;
+        bool on_number(double) {
+            ++numbers;
+            return true;
+        }
+        bool on_key(std::string_view key) { return key != "stop"; }
+    };
+} // namespace
+
+TEST_CASE("SAX events follow the document") {
+    Recorder recorder;
+    auto status = choochoo::json::sax::parse(
+        R"({"name": "A\"lice", "tags": ["x", 2, true, null, {}, []], "nested": {"k\n": false}})", recorder);
+    REQUIRE(status);
+    REQUIRE(status.value() == choochoo::json::sax::Status::COMPLETE);
+    const std::vector<std::string> expected = {"{", "k:name", "s:A\"lice", "k:tags", "[", "s:x", "n:2",
+                                               "true", "null", "{", "}", "[", "]", "]", "k:nested", "{",
+                                               "k:k\n", "false", "}", "}"};
+    REQUIRE(recorder.events == expected);
+
+    Recorder scalar;
+    REQUIRE(choochoo::json::sax::parse(" 42 ", scalar));
+    REQUIRE(scalar.events == std::vector<std::string>{"n:42"});
+}
+
+TEST_CASE("SAX handlers can stop early") {
+    Counter counter;
+    auto status = choochoo::json::sax::parse(R"({"a": [1, 2, 3], "stop": [4, 5], "b": not even json)", counter);
+    REQUIRE(status);
+    REQUIRE(status.value() == choochoo::json::sax::Status::STOPPED);
+    REQUIRE(counter.numbers == 3);
+
+    Counter all;
+    status = choochoo::json::sax::parse(R"([1, {"x": 2}, [3, [4]]])", all);
+    REQUIRE(status.value() == choochoo::json::sax::Status::COMPLETE);
+    REQUIRE(all.numbers == 4);
+}
+
+TEST_CASE("SAX parsing reads streams and deep nesting") {
+    std::istringstream stream(R"({"list": ["a\tb", 1.5e3], "ok": true})");
+    choochoo::json::Lexer lexer(stream, 4);
+    Recorder recorder;
+    REQUIRE(choochoo::json::sax::parse(lexer, recorder));
+    const std::vector<std::string> expected = {"{", "k:list", "[", "s:a\tb", "n:1500", "]", "k:ok", "true", "}"};
+    REQUIRE(recorder.events == expected);
+
+    // Far deeper than any call stack would allow
+    const size_t depth = 200000;
+    const std::string deep = std::string(depth, '[') + std::string(depth, ']');
+    choochoo::json::sax::BaseHandler ignore;
+    REQUIRE(choochoo::json::sax::parse(deep, ignore).value() == choochoo::json::sax::Status::COMPLETE);
+}
+
+TEST_CASE("SAX parsing reports syntax errors") {
+    choochoo::json::sax::BaseHandler ignore;
+    const auto error_of = [&ignore](std::string_view json) {
+        auto result = choochoo::json::sax::parse(json, ignore);
+        REQUIRE_FALSE(result);
+        return result.error().message();
+    };
+    REQUIRE(error_of(R"({"a" 1})") == "Expected ':' after object key, but found NUMBER at line 1, column 6.");
+    REQUIRE(error_of("[1 2]") == "Expected ',' or ']' in array, but found NUMBER at line 1, column 4.");
+    REQUIRE(error_of("{1: 2}").starts_with("Expected string key in object"));
+    REQUIRE(error_of("[1,]") == "Unexpected token RBRACKET at line 1, column 4.");
+    REQUIRE(error_of("[1] 2") == "Unexpected content after JSON value at line 1, column 5.");
+    REQUIRE(error_of("[\"\\x\"]") == "Invalid escape sequence at line 1, column 3.");
+    REQUIRE(error_of("") == "No value to parse (unexpected EOF) at line 1, column 1.");
+}
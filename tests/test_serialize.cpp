@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "choochoo/json.hpp"
+
+namespace {
+    choochoo::json::Value parse(const std::string& json) {
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer);
+        auto result = parser.parse();
+        REQUIRE(result);
+        return std::move(result.value());
+    }
+} // namespace
+
+TEST_CASE("Compact output round-trips and has no whitespace") {
+    std::string json =
+        R"({"name": "Alice", "tags": ["a", "b"], "meta": {"empty": {}, "none": [], "ok": true}, "n": null})";
+    auto value = parse(json);
+    const std::string compact = choochoo::json::dump(value);
+    REQUIRE(compact == R"({"name":"Alice","tags":["a","b"],"meta":{"empty":{},"none":[],"ok":true},"n":null})");
+    REQUIRE(choochoo::json::dump(parse(compact)) == compact);
+}
+
+TEST_CASE("Indented output matches pretty()") {
+    auto value = parse(R"({"list": [1, [], {"k": "v"}], "empty": {}})");
+    const std::string indented = choochoo::json::dump(value, {.indent = 2});
+    REQUIRE(indented == R"({
+  "list": [
+    1,
+    [],
+    {
+      "k": "v"
+    }
+  ],
+  "empty": {}
+})");
+    REQUIRE(value.pretty() == indented);
+    REQUIRE(choochoo::json::dump(value, {.indent = 1}).find("\n \"list\": [\n  1,") != std::string::npos);
+}
+
+TEST_CASE("Numbers use the shortest form that round-trips") {
+    using choochoo::json::Value;
+    const auto text = [](double number) { return choochoo::json::dump(Value::number(number)); };
+
+    REQUIRE(text(0) == "0");
+    REQUIRE(text(-0.0) == "-0");
+    REQUIRE(text(30) == "30");
+    REQUIRE(text(-1.5) == "-1.5");
+    REQUIRE(text(0.1 + 0.2) == "0.30000000000000004");
+    REQUIRE(text(1e21) == "1e+21");
+    REQUIRE(text(5e-324) == "5e-324");
+    REQUIRE(text(std::numeric_limits<double>::max()) == "1.7976931348623157e+308");
+    REQUIRE(text(std::nan("")) == "null");
+    REQUIRE(text(std::numeric_limits<double>::infinity()) == "null");
+
+    for (double number : {0.1, 1.0 / 3, 123456789.123456789, 2.5e-8, 9007199254740993.0}) {
+        auto reparsed = parse(text(number));
+        REQUIRE(reparsed.as_number() == number);
+    }
+}
+
+TEST_CASE("Strings and keys are escaped") {
+    using choochoo::json::Value;
+    choochoo::json::Object object;
+    const std::string text_with_specials = "tab\there \"quoted\" back\\slash \x01 \x1f caf\xc3\xa9";
+    object.emplace(choochoo::json::KeyTable::global()->intern("quote\"key"),
+                   Value::string(text_with_specials, std::pmr::get_default_resource()));
+    const std::string text = choochoo::json::dump(Value::object(std::move(object)));
+    REQUIRE(text == R"({"quote\"key":"tab\there \"quoted\" back\\slash \u0001 \u001f caf)" "\xc3\xa9" R"("})");
+    REQUIRE(parse(text)["quote\"key"].as_string() == text_with_specials);
+}
+
+TEST_CASE("Serializing to a stream, an output iterator and a reused buffer") {
+    // Large enough to be written in several chunks
+    choochoo::json::Array items;
+    for (int i = 0; i < 20000; ++i) {
+        items.push_back(choochoo::json::Value::string("item " + std::to_string(i), std::pmr::get_default_resource()));
+    }
+    const auto value = choochoo::json::Value::array(std::move(items));
+    const std::string expected = choochoo::json::dump(value);
+    REQUIRE(expected.size() > 2 * choochoo::json::SERIALIZE_CHUNK_SIZE);
+
+    std::ostringstream stream;
+    choochoo::json::serialize(value, stream);
+    REQUIRE(stream.str() == expected);
+
+    std::vector<char> chars;
+    choochoo::json::serialize(value, std::back_inserter(chars));
+    REQUIRE(std::string(chars.begin(), chars.end()) == expected);
+
+    size_t chunks = 0;
+    choochoo::json::serialize_chunks(value, [&chunks](std::string_view) { ++chunks; });
+    REQUIRE(chunks >= 3);
+
+    std::string buffer = "prefix:";
+    choochoo::json::serialize(choochoo::json::Value::boolean(true), buffer);
+    REQUIRE(buffer == "prefix:true");
+    buffer.clear();
+    choochoo::json::serialize(value, buffer);
+    REQUIRE(buffer == expected);
+}
@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <string_view>
+#include "choochoo/simd.hpp"
+
+TEST_CASE("find_string_special stops at quotes, backslashes and control characters") {
+    using choochoo::json::simd::find_string_special;
+
+    for (size_t prefix : {0, 1, 15, 16, 17, 31, 32, 33, 100}) {
+        for (char special : {'"', '\\', '\n', '\0', '\x1f'}) {
+            std::string text(prefix, 'x');
+            text += special;
+            text += std::string(40, 'y');
+            const char* found = find_string_special(text.data(), text.data() + text.size());
+            REQUIRE(found == text.data() + prefix);
+        }
+    }
+
+    // Bytes above 0x7f (UTF-8) and 0x20 itself are plain string content
+    std::string plain = "caf\xc3\xa9 \x7f with spaces and more than thirty-two bytes of text";
+    REQUIRE(find_string_special(plain.data(), plain.data() + plain.size()) == plain.data() + plain.size());
+}
+
+TEST_CASE("skip_whitespace counts newlines and finds the start of the last line") {
+    using choochoo::json::simd::skip_whitespace;
+
+    for (size_t indent : {0, 1, 15, 16, 17, 40, 80}) {
+        std::string text = "\r\n" + std::string(indent, ' ') + "\n\t" + std::string(indent, ' ') + "x   ";
+        size_t newlines = 0;
+        const char* line_start = nullptr;
+        const char* stop = skip_whitespace(text.data(), text.data() + text.size(), newlines, line_start);
+        REQUIRE(stop == text.data() + text.find('x'));
+        REQUIRE(newlines == 2);
+        REQUIRE(line_start == text.data() + text.rfind('\n') + 1);
+    }
+
+    std::string blank(70, ' ');
+    size_t newlines = 0;
+    const char* line_start = nullptr;
+    REQUIRE(skip_whitespace(blank.data(), blank.data() + blank.size(), newlines, line_start) ==
+            blank.data() + blank.size());
+    REQUIRE(newlines == 0);
+    REQUIRE(line_start == nullptr);
+}
+
+TEST_CASE("escape_string copies clean runs and escapes only what JSON requires") {
+    using choochoo::json::simd::escape_string;
+
+    std::string out = "prefix:";
+    escape_string(out, std::string_view("a\"b\\c\b\f\n\r\t\x01\x1f\0 caf\xc3\xa9 \x7f", 21));
+    REQUIRE(out == "prefix:\"a\\\"b\\\\c\\b\\f\\n\\r\\t\\u0001\\u001f\\u0000 caf\xc3\xa9 \x7f\"");
+
+    // Escapes on either side of a full vector and runs of consecutive escapes
+    for (size_t prefix : {0, 1, 15, 16, 17, 31, 32, 33, 100}) {
+        const std::string clean(prefix, 'x');
+        std::string escaped;
+        escape_string(escaped, clean + "\"\"\n" + clean);
+        REQUIRE(escaped == "\"" + clean + "\\\"\\\"\\n" + clean + "\"");
+    }
+
+    std::string empty;
+    escape_string(empty, "");
+    REQUIRE(empty == "\"\"");
+}
@@ -1,18 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <sstream>
-#include <unordered_map>
 #include "choochoo/json.hpp"
 
-// Helper to find interned key pointer in object map
-const std::string* find_key(const std::unordered_map<const std::string*, choochoo::json::Value>& obj,
-                            const std::string& key) {
-    for (const auto& [kptr, _] : obj) {
-        if (*kptr == key)
-            return kptr;
-    }
-    return nullptr;
-}
-
 TEST_CASE("Streaming lexer/parser parses valid JSON from std::istringstream") {
     std::string json = R"({
         "name": "Streamy",
@@ -35,21 +24,17 @@ TEST_CASE("Streaming lexer/parser parses valid JSON from std::istringstream") {
     REQUIRE(obj_opt.has_value());
     const auto& obj = obj_opt->get();
 
-    const std::string* name_kptr = find_key(obj, "name");
-    REQUIRE(name_kptr);
-    REQUIRE(obj.at(name_kptr).as_string()->get() == "Streamy");
+    REQUIRE(obj.contains("name"));
+    REQUIRE(obj.at("name").as_string().value() == "Streamy");
 
-    const std::string* age_kptr = find_key(obj, "age");
-    REQUIRE(age_kptr);
-    REQUIRE(obj.at(age_kptr).as_number().value() == 99);
+    REQUIRE(obj.contains("age"));
+    REQUIRE(obj.at("age").as_number().value() == 99);
 
-    const std::string* active_kptr = find_key(obj, "active");
-    REQUIRE(active_kptr);
-    REQUIRE(obj.at(active_kptr).as_boolean().value() == false);
+    REQUIRE(obj.contains("active"));
+    REQUIRE(obj.at("active").as_boolean().value() == false);
 
-    const std::string* scores_kptr = find_key(obj, "scores");
-    REQUIRE(scores_kptr);
-    auto scores_opt = obj.at(scores_kptr).as_array();
+    REQUIRE(obj.contains("scores"));
+    auto scores_opt = obj.at("scores").as_array();
     REQUIRE(scores_opt.has_value());
     const auto& scores = scores_opt->get();
     REQUIRE(scores.size() == 3);
@@ -57,17 +42,14 @@ TEST_CASE("Streaming lexer/parser parses valid JSON from std::istringstream") {
     REQUIRE(scores[1].as_number().value() == 20);
     REQUIRE(scores[2].as_number().value() == 30);
 
-    const std::string* meta_kptr = find_key(obj, "meta");
-    REQUIRE(meta_kptr);
-    auto meta_opt = obj.at(meta_kptr).as_object();
+    REQUIRE(obj.contains("meta"));
+    auto meta_opt = obj.at("meta").as_object();
     REQUIRE(meta_opt.has_value());
     const auto& meta = meta_opt->get();
-    const std::string* created_kptr = find_key(meta, "created");
-    REQUIRE(created_kptr);
-    REQUIRE(meta.at(created_kptr).as_string()->get() == "2024");
-    const std::string* verified_kptr = find_key(meta, "verified");
-    REQUIRE(verified_kptr);
-    REQUIRE(meta.at(verified_kptr).as_boolean().value() == true);
+    REQUIRE(meta.contains("created"));
+    REQUIRE(meta.at("created").as_string().value() == "2024");
+    REQUIRE(meta.contains("verified"));
+    REQUIRE(meta.at("verified").as_boolean().value() == true);
 }
 
 TEST_CASE("Streaming lexer/parser fails on malformed JSON") {
@@ -79,8 +61,8 @@ TEST_CASE("Streaming lexer/parser fails on malformed JSON") {
 
     auto result = parser.parse();
     REQUIRE_FALSE(result);
-    bool found_unexpected = result.error().find("Unexpected token") != std::string::npos;
-    bool found_no_value = result.error().find("No value to parse") != std::string::npos;
+    bool found_unexpected = result.error().message().find("Unexpected token") != std::string::npos;
+    bool found_no_value = result.error().message().find("No value to parse") != std::string::npos;
     if (!(found_unexpected || found_no_value)) {
         FAIL("Error message did not contain expected substrings");
     }
@@ -102,13 +84,49 @@ TEST_CASE("Streaming lexer/parser parses empty array and object") {
     REQUIRE(obj_opt.has_value());
     const auto& obj = obj_opt->get();
 
-    const std::string* empty_obj_kptr = find_key(obj, "empty_obj");
-    REQUIRE(empty_obj_kptr);
-    REQUIRE(obj.at(empty_obj_kptr).type() == choochoo::json::Type::OBJECT);
-    REQUIRE(obj.at(empty_obj_kptr).as_object()->get().empty());
+    REQUIRE(obj.contains("empty_obj"));
+    REQUIRE(obj.at("empty_obj").type() == choochoo::json::Type::OBJECT);
+    REQUIRE(obj.at("empty_obj").as_object()->get().empty());
+
+    REQUIRE(obj.contains("empty_arr"));
+    REQUIRE(obj.at("empty_arr").type() == choochoo::json::Type::ARRAY);
+    REQUIRE(obj.at("empty_arr").as_array()->get().empty());
+}
 
-    const std::string* empty_arr_kptr = find_key(obj, "empty_arr");
-    REQUIRE(empty_arr_kptr);
-    REQUIRE(obj.at(empty_arr_kptr).type() == choochoo::json::Type::ARRAY);
-    REQUIRE(obj.at(empty_arr_kptr).as_array()->get().empty());
+TEST_CASE("Streaming lexer handles tokens straddling block boundaries") {
+    std::string long_string(300, 'z');
+    std::string json = R"({"key": "value with \"escapes\"", "long": ")" + long_string +
+                       R"(", "numbers": [12345.678e-2, -0.5, 1000000], "flags": [true, false, null]})";
+
+    choochoo::json::Lexer string_lexer(json);
+    choochoo::json::Parser string_parser(string_lexer);
+    auto expected = string_parser.parse();
+    REQUIRE(expected);
+
+    for (size_t block_size : {1, 2, 7, 64, 4096}) {
+        std::istringstream stream(json);
+        choochoo::json::Lexer lexer(stream, block_size);
+        choochoo::json::Parser parser(lexer);
+        auto result = parser.parse();
+        REQUIRE(result);
+        REQUIRE(result.value().pretty() == expected.value().pretty());
+    }
+}
+
+TEST_CASE("Streaming tokens view the lexer buffer") {
+    std::string json = R"({"name": "a long enough string value", "n": [-12.5e3, true, null]})";
+    choochoo::json::Lexer string_lexer(json);
+    auto expected = string_lexer.tokenize();
+
+    for (size_t block_size : {1, 3, 16, 4096}) {
+        std::istringstream stream(json);
+        choochoo::json::Lexer lexer(stream, block_size);
+        auto tokens = lexer.tokenize();
+        REQUIRE(tokens.size() == expected.size());
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            REQUIRE(tokens[i].type_ == expected[i].type_);
+            REQUIRE(tokens[i].value == expected[i].value);
+            REQUIRE(tokens[i].offset == expected[i].offset);
+        }
+    }
 }
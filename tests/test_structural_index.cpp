@@ -0,0 +1,165 @@
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+#include "choochoo/json.hpp"
+
+namespace {
+    std::expected<choochoo::json::Value, choochoo::json::Error> parse_indexed(const std::string& json) {
+        auto index = choochoo::json::StructuralIndex::build(json);
+        if (!index)
+            return std::unexpected(index.error());
+        choochoo::json::Lexer lexer(json);
+        choochoo::json::Parser parser(lexer, index.value());
+        auto result = parser.parse();
+        if (!result)
+            return std::unexpected(result.error());
+        return std::move(result.value());
+    }
+
+    /// Structural equality that ignores member order, which is not part of a parsed tree's identity.
+    bool same_tree(const choochoo::json::Value& a, const choochoo::json::Value& b) {
+        using choochoo::json::Type;
+        if (a.type() != b.type()) {
+            return false;
+        }
+        if (a.type() == Type::ARRAY) {
+            const auto& a_items = a.as_array()->get();
+            const auto& b_items = b.as_array()->get();
+            if (a_items.size() != b_items.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a_items.size(); ++i) {
+                if (!same_tree(a_items[i], b_items[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (a.type() == Type::OBJECT) {
+            if (a.as_object()->get().size() != b.as_object()->get().size()) {
+                return false;
+            }
+            for (const auto& [key, value] : a.as_object()->get()) {
+                const auto* other = b.find(*key);
+                if (other == nullptr || !same_tree(value, *other)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        return a.pretty() == b.pretty();
+    }
+} // namespace
+
+TEST_CASE("Structural index records operators, quotes and scalar starts") {
+    std::string json = R"({"a": [1, true], "b\"}": null})";
+    auto index = choochoo::json::StructuralIndex::build(json);
+    REQUIRE(index);
+
+    std::string structurals;
+    for (auto offset : index->offsets()) {
+        structurals += json[offset];
+    }
+    // The escaped quote and the brace inside the second key are string content
+    REQUIRE(structurals == R"({"":[1,t],"":n})");
+}
+
+TEST_CASE("Structural index handles strings spanning blocks and escaped backslashes") {
+    std::string long_value(150, 'x');
+    std::string json = R"({"key": ")" + long_value + R"(\\", "k2": "\\\"{[", "k3": [1,2,3]})";
+    auto index = choochoo::json::StructuralIndex::build(json);
+    REQUIRE(index);
+
+    std::string structurals;
+    for (auto offset : index->offsets()) {
+        structurals += json[offset];
+    }
+    REQUIRE(structurals == R"({"":"","":"","":[1,2,3]})");
+}
+
+TEST_CASE("Structural index flags the strings that contain escapes") {
+    // The second value spans three blocks with its only escape in the middle one; the last key ends in a block of
+    // its own after an escape at the very end of the previous block
+    std::string json = R"({"plain": ")" + std::string(60, 'x') + R"(\n)" + std::string(70, 'y') + R"(", "a\"b": 1, )";
+    json += std::string(190 - json.size(), ' ') + R"("\u0041": "done"})";
+    auto index = choochoo::json::StructuralIndex::build(json);
+    REQUIRE(index);
+
+    std::vector<std::string> escaped;
+    std::vector<std::string> plain;
+    const auto& offsets = index->offsets();
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        if (json[offsets[i]] != '"') {
+            continue;
+        }
+        const std::string text = json.substr(offsets[i] + 1, offsets[i + 1] - offsets[i] - 1);
+        (index->has_escapes(i) ? escaped : plain).push_back(text.substr(0, 3));
+        ++i; // closing quote
+    }
+    REQUIRE(escaped == std::vector<std::string>{"xxx", "a\\\"", "\\u0"});
+    REQUIRE(plain == std::vector<std::string>{"pla", "don"});
+}
+
+TEST_CASE("Unterminated string fails to index") {
+    std::string json = "{\"key\":\n  \"value";
+    auto index = choochoo::json::StructuralIndex::build(json);
+    REQUIRE_FALSE(index);
+    REQUIRE(index.error().code == choochoo::json::ErrorCode::UNTERMINATED_STRING);
+    REQUIRE(index.error().offset == 10);
+    REQUIRE(index.error().message() == "Unterminated string at line 2, column 3.");
+}
+
+TEST_CASE("Index-driven parse matches lexer-driven parse") {
+    std::string json = R"({
+        "name": "Alice",
+        "age": 30.5,
+        "active": true,
+        "tags": ["a", "b\nc", ""],
+        "meta": {"created": "2024", "nothing": null, "nested": [[], {}]}
+    })";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    auto expected = parser.parse();
+    REQUIRE(expected);
+
+    auto result = parse_indexed(json);
+    REQUIRE(result);
+    REQUIRE(same_tree(*result, *expected));
+}
+
+TEST_CASE("Index-driven parse rejects malformed input") {
+    REQUIRE_FALSE(parse_indexed(R"([12abc])"));
+    REQUIRE_FALSE(parse_indexed(R"([1, 2,])"));
+    REQUIRE_FALSE(parse_indexed(R"({"a" 1})"));
+    REQUIRE_FALSE(parse_indexed(R"({"a": 1} extra)"));
+    REQUIRE_FALSE(parse_indexed(R"([tru])"));
+    REQUIRE_FALSE(parse_indexed(""));
+}
+
+TEST_CASE("Index-driven parse rejects raw control characters in strings") {
+    // Long enough that the string spans blocks and the newline lands in the second one
+    const std::string json = "[\"" + std::string(70, 'x') + "\n\", 1]";
+    choochoo::json::Lexer lexer(json);
+    choochoo::json::Parser parser(lexer);
+    const auto expected = parser.parse();
+    REQUIRE_FALSE(expected);
+    REQUIRE(expected.error().code == choochoo::json::ErrorCode::CONTROL_CHARACTER);
+
+    auto index = choochoo::json::StructuralIndex::build(json);
+    REQUIRE(index);
+    choochoo::json::Lexer index_lexer(json);
+    choochoo::json::Parser index_parser(index_lexer, index.value());
+    const auto result = index_parser.parse();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().code == expected.error().code);
+    REQUIRE(result.error().offset == expected.error().offset);
+    REQUIRE(result.error().line == expected.error().line);
+    REQUIRE(result.error().column == expected.error().column);
+}
+
+TEST_CASE("Index-driven parse reports line and column of errors") {
+    auto result = parse_indexed("{\n  \"a\": 1,\n  \"b\": }");
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().line == 3);
+    REQUIRE(result.error().column == 8);
+}
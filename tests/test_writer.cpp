@@ -0,0 +1,160 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "choochoo/json.hpp"
+
+TEST_CASE("Writer produces compact JSON without a Value tree") {
+    std::string out;
+    choochoo::json::Writer writer(out);
+    writer.begin_object()
+        .key("name")
+        .value("Alice")
+        .key("tags")
+        .begin_array()
+        .value("a")
+        .value(true)
+        .null()
+        .begin_object()
+        .end_object()
+        .end_array()
+        .key("score")
+        .value(1.5)
+        .end_object();
+    REQUIRE(writer.complete());
+    REQUIRE(writer.finish());
+    REQUIRE(out == R"({"name":"Alice","tags":["a",true,null,{}],"score":1.5})");
+}
+
+TEST_CASE("Writer indents like serialize()") {
+    choochoo::json::Lexer lexer(R"({"list": [1, [], {"k": "v"}], "empty": {}, "s": "a\"b"})");
+    choochoo::json::Parser parser(lexer);
+    auto value = parser.parse();
+    REQUIRE(value);
+
+    std::string by_hand;
+    choochoo::json::Writer writer(by_hand, {.indent = 2});
+    writer.begin_object().key("list").begin_array().value(1).begin_array().end_array();
+    writer.begin_object().key("k").value("v").end_object().end_array();
+    writer.key("empty").begin_object().end_object().key("s").value("a\"b").end_object();
+    REQUIRE(writer.finish());
+    REQUIRE(by_hand == choochoo::json::dump(value.value(), {.indent = 2}));
+
+    // A Value can also be embedded in a larger stream
+    std::string embedded;
+    choochoo::json::Writer wrapper(embedded);
+    wrapper.begin_array().value(value.value()).value(2).end_array();
+    REQUIRE(embedded == "[" + choochoo::json::dump(value.value()) + ",2]");
+}
+
+TEST_CASE("Writer writes integers exactly") {
+    std::string out;
+    choochoo::json::Writer writer(out);
+    writer.begin_array()
+        .value(std::numeric_limits<int64_t>::min())
+        .value(std::numeric_limits<uint64_t>::max())
+        .value(9007199254740993LL)
+        .value(static_cast<short>(-7))
+        .end_array();
+    REQUIRE(writer.finish());
+    REQUIRE(out == "[-9223372036854775808,18446744073709551615,9007199254740993,-7]");
+}
+
+TEST_CASE("Writer streams to a file descriptor and a std::ostream in bounded chunks") {
+    // Large enough to need several chunks
+    const auto write_document = [](choochoo::json::Writer& writer) {
+        writer.begin_array();
+        for (int i = 0; i < 20000; ++i) {
+            writer.begin_object().key("id").value(i).key("label").value("item\n").end_object();
+        }
+        writer.end_array();
+    };
+    std::string expected;
+    {
+        choochoo::json::Writer writer(expected);
+        write_document(writer);
+        REQUIRE(writer.finish());
+    }
+    REQUIRE(expected.size() > 4 * choochoo::json::SERIALIZE_CHUNK_SIZE);
+
+    std::vector<size_t> chunk_sizes;
+    std::string chunked;
+    {
+        choochoo::json::Writer writer([&](std::string_view chunk) {
+            chunk_sizes.push_back(chunk.size());
+            chunked += chunk;
+        });
+        write_document(writer);
+        REQUIRE(writer.finish());
+    }
+    REQUIRE(chunked == expected);
+    REQUIRE(chunk_sizes.size() > 1);
+    for (size_t size : chunk_sizes) {
+        REQUIRE(size < 2 * choochoo::json::SERIALIZE_CHUNK_SIZE);
+    }
+
+    std::ostringstream stream;
+    {
+        choochoo::json::Writer writer(stream);
+        write_document(writer);
+        REQUIRE(writer.finish());
+    }
+    REQUIRE(stream.str() == expected);
+
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    {
+        choochoo::json::Writer writer(fileno(file));
+        write_document(writer);
+        REQUIRE(writer.finish());
+    }
+    std::string from_file(expected.size() + 1, '\0');
+    std::rewind(file);
+    from_file.resize(std::fread(from_file.data(), 1, from_file.size(), file));
+    std::fclose(file);
+    REQUIRE(from_file == expected);
+}
+
+TEST_CASE("Writer reports incomplete documents and output errors") {
+    std::string out;
+    choochoo::json::Writer writer(out);
+    writer.begin_object().key("open");
+    REQUIRE_FALSE(writer.complete());
+    const auto result = writer.finish();
+    REQUIRE_FALSE(result);
+    REQUIRE(result.error().find("incomplete") != std::string::npos);
+
+    std::ostringstream stream;
+    stream.setstate(std::ios::badbit);
+    choochoo::json::Writer failing(stream);
+    failing.value("text");
+    const auto failed = failing.finish();
+    REQUIRE_FALSE(failed);
+    REQUIRE(failed.error() == "Cannot write to stream");
+}
+
+#ifndef NDEBUG
+TEST_CASE("Writer rejects misuse in debug builds") {
+    std::string out;
+    {
+        choochoo::json::Writer writer(out);
+        writer.begin_object();
+        REQUIRE_THROWS_AS(writer.value(1), std::logic_error);
+        REQUIRE_THROWS_AS(writer.end_array(), std::logic_error);
+        writer.key("k");
+        REQUIRE_THROWS_AS(writer.key("again"), std::logic_error);
+        REQUIRE_THROWS_AS(writer.end_object(), std::logic_error);
+    }
+    {
+        choochoo::json::Writer writer(out);
+        REQUIRE_THROWS_AS(writer.key("k"), std::logic_error);
+        writer.begin_array().end_array();
+        REQUIRE_THROWS_AS(writer.value("second root"), std::logic_error);
+    }
+}
+#endif